@@ -5,6 +5,7 @@ extern "C"
 }
 
 #include "FFDecode.h"
+#include "XFramePool.h"
 #include "XLog.h"
 void FFDecode::InitHard(void *vm)
 {
@@ -23,10 +24,9 @@ void FFDecode::Clear()
 void FFDecode::Close()
 {
     IDecode::Clear();
+    cache.Clear();
     mux.lock();
     pts = 0;
-    if(frame)
-        av_frame_free(&frame);
     if(codec)
     {
         avcodec_close(codec);
@@ -60,7 +60,18 @@ bool FFDecode::Open(XParameter para,bool isHard)
     codec = avcodec_alloc_context3(cd);
     avcodec_parameters_to_context(codec,p);
 
-    codec->thread_count = 8;
+    //解码输出帧的pts与输入packet使用同一时间基
+    timeBase = para.timeBase;
+    codec->pkt_timebase.num = timeBase.num;
+    codec->pkt_timebase.den = timeBase.den;
+
+    codec->thread_count = threadCount;
+    if(isKeyOnly)
+        codec->skip_frame = AVDISCARD_NONKEY;
+    if(lowres > 0)
+        codec->lowres = lowres < cd->max_lowres ? lowres : cd->max_lowres;
+    catchUpLevel = 0;
+    catchUpCount = 0;
     //3 打开解码器
     int re = avcodec_open2(codec,0,0);
     if(re != 0)
@@ -85,6 +96,21 @@ bool FFDecode::Open(XParameter para,bool isHard)
     return true;
 }
 
+void FFDecode::SetCatchUp(int level)
+{
+    mux.lock();
+    catchUpLevel = level;
+    if(codec)
+    {
+        codec->skip_loop_filter = level >= 1 ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+        if(isKeyOnly)
+            codec->skip_frame = AVDISCARD_NONKEY;
+        else
+            codec->skip_frame = level >= 2 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    }
+    mux.unlock();
+}
+
 bool FFDecode::SendPacket(XData pkt)
 {
     if(pkt.size<=0 || !pkt.data)return false;
@@ -103,6 +129,19 @@ bool FFDecode::SendPacket(XData pkt)
     return true;
 }
 
+bool FFDecode::Drain()
+{
+    mux.lock();
+    if(!codec)
+    {
+        mux.unlock();
+        return false;
+    }
+    int re = avcodec_send_packet(codec,0);
+    mux.unlock();
+    return re == 0;
+}
+
 //从线程中获取解码结果
 XData FFDecode::RecvFrame()
 {
@@ -112,18 +151,17 @@ XData FFDecode::RecvFrame()
         mux.unlock();
         return XData();
     }
-    if(!frame)
-    {
-        frame = av_frame_alloc();
-    }
+    //从帧池取出，解码器输出的是引用计数的帧数据，帧归还时释放引用
+    AVFrame *frame = XFramePool::Get()->Alloc();
     int re = avcodec_receive_frame(codec,frame);
     if(re != 0)
     {
         mux.unlock();
+        XFramePool::Get()->Free(&frame);
         return XData();
     }
     XData d;
-    d.data = (unsigned char *)frame;
+    d.Attach(AVFRAME_TYPE,(unsigned char *)frame,0);
     if(codec->codec_type == AVMEDIA_TYPE_VIDEO)
     {
         d.size = (frame->linesize[0] + frame->linesize[1] + frame->linesize[2])*frame->height;
@@ -139,7 +177,10 @@ XData FFDecode::RecvFrame()
     //if(!isAudio)
     //    XLOGE("data format is %d",frame->format);
     memcpy(d.datas,frame->data,sizeof(d.datas));
-    d.pts = frame->pts;
+    d.pts = frame->pts != AV_NOPTS_VALUE ? frame->pts : frame->best_effort_timestamp;
+    d.dts = frame->pkt_dts;
+    d.timeBase = timeBase;
+    d.isKey = frame->key_frame != 0;
     pts = d.pts;
     mux.unlock();
     return d;
@@ -18,13 +18,28 @@ public:
     //future模型 发送数据到线程解码
     virtual bool SendPacket(XData pkt);
 
-    //从线程中获取解码结果，再次调用会复用上次空间，线程不安全
+    //追赶等级 0正常 1跳过环路滤波 2再跳过非参考帧
+    virtual void SetCatchUp(int level);
+
+    //从线程中获取解码结果，每次从帧池取出新的AVFrame，由最后一个引用归还
     virtual XData RecvFrame();
 
+    //送入空包，之后RecvFrame取出解码器缓存的帧，再次解码前需要Clear
+    virtual bool Drain();
+
+    //以下在Open前设置
+    //只解码关键帧（缩略图）
+    bool isKeyOnly = false;
+    //低分辨率解码 0原始 1一半 2四分之一，解码器不支持时忽略
+    int lowres = 0;
+    //解码线程数
+    int threadCount = 8;
+
 protected:
     AVCodecContext *codec = 0;
-    AVFrame *frame = 0;
     std::mutex mux;
+    //输入packet的时间基，解码输出帧沿用
+    XRational timeBase;
 };
 
 
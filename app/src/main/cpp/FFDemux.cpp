@@ -1,22 +1,48 @@
 #include "FFDemux.h"
 #include "XLog.h"
+#include "XPacketPool.h"
+#include "XClock.h"
+#include "FFStreamInfo.h"
+#include <cstring>
 extern "C"{
 #include <libavformat/avformat.h>
 }
 
-//分数转为浮点数
-static double r2d(AVRational r)
-{
-    return r.num == 0 || r.den == 0 ?0.:(double) r.num/(double)r.den;
-}
 void FFDemux::Close()
 {
     mux.lock();
     if(ic)
         avformat_close_input(&ic);
+    //自定义IO不由ffmpeg关闭
+    if(isCacheOpen)
+    {
+        XIOStats st = ioCache.GetStats();
+        XLOGI("io cache hit rate %.2f fetch %lld bytes disk %lld bytes read %lld bytes",
+              st.HitRate(), st.fetchBytes, st.diskBytes, st.readBytes);
+        ioCache.Close();
+        isCacheOpen = false;
+    }
+    if(isMmapOpen)
+    {
+        XMmapStats st = mmapIO.GetStats();
+        XLOGI("mmap io read %lld bytes in %lld calls seek %lld advise %lld",
+              st.readBytes, st.reads, st.seeks, st.advises);
+        mmapIO.Close();
+        isMmapOpen = false;
+    }
+    keyIndex.Clear();
+    vPara = XParameter();
+    aPara = XParameter();
+    avcodec_parameters_free(&vCodecPar);
+    avcodec_parameters_free(&aCodecPar);
     mux.unlock();
 }
 
+XIOStats FFDemux::GetIOStats()
+{
+    return ioCache.GetStats();
+}
+
 //seek 位置 pos 0.0~1.0
 bool FFDemux::Seek(double pos)
 {
@@ -34,11 +60,43 @@ bool FFDemux::Seek(double pos)
     }
     //清理读取的缓冲
     avformat_flush(ic);
+    AVStream *st = ic->streams[videoStream];
+    XRational tb;
+    tb.num = st->time_base.num;
+    tb.den = st->time_base.den;
+    //与播放器按总时长换算的目标一致，没有总时长时用流的时长
     long long seekPts = 0;
-    seekPts = ic->streams[videoStream]->duration*pos;
+    if(totalMs > 0)
+        seekPts = XPosToPts(pos,totalMs,tb);
+    else if(st->duration > 0)
+        seekPts = (long long)(st->duration*pos);
 
-    //往后跳转到关键帧
-    re = av_seek_frame(ic,videoStream,seekPts,AVSEEK_FLAG_FRAME|AVSEEK_FLAG_BACKWARD);
+    //索引能确定目标之前的关键帧时，直接跳到该关键帧，并提前得到需要解码的长度
+    //索引还没覆盖到目标（边读边建立），由ffmpeg查找
+    XKeyFrame key;
+    long long last = 0;
+    bool isKnown = keyIndex.Find(seekPts,key) &&
+            (keyIndex.isFull || (keyIndex.LastPts(last) && last >= seekPts));
+    if(isKnown)
+    {
+        //容器没有索引（TS FLV等），ffmpeg按时间戳跳转要二分读取文件查找，直接跳到读取时记录的字节位置
+        //容器有索引时ffmpeg直接查索引，按时间戳跳转
+        bool isByte = !keyIndex.isFull && key.pos >= 0 && !(ic->iformat->flags & AVFMT_NO_BYTE_SEEK);
+        if(isByte)
+            re = av_seek_frame(ic,videoStream,key.pos,AVSEEK_FLAG_BYTE) >= 0;
+        //容器索引按解码时间戳查找，换回平移前的值
+        if(!re)
+            re = av_seek_frame(ic,videoStream,key.pts - (keyIndex.isFull ? indexShift : 0),AVSEEK_FLAG_BACKWARD) >= 0;
+        seekGapMs = XPtsToMs(seekPts - key.pts,tb);
+        isSeekGapExact = !keyIndex.isFull;
+    }
+    else
+    {
+        //往后跳转到关键帧
+        re = av_seek_frame(ic,videoStream,seekPts,AVSEEK_FLAG_BACKWARD) >= 0;
+        seekGapMs = -1;
+        isSeekGapExact = false;
+    }
     mux.unlock();
     return re;
 }
@@ -49,9 +107,36 @@ bool FFDemux::Open(const char *url)
     XLOGI("Open file %s begin",url);
     Close();
     mux.lock();
+    double begin = XNowMs();
+    //网络文件使用块缓存作为自定义IO
+    bool isCacheUrl = !strncmp(url,"http://",7) || !strncmp(url,"https://",8);
+    if(isIOCache && isCacheUrl && ioCache.Open(url))
+    {
+        isCacheOpen = true;
+        ic = avformat_alloc_context();
+        ic->pb = ioCache.GetIO();
+    }
+    //本地文件映射到内存读取，映射失败使用ffmpeg的file协议
+    else if(isMmap && url[0] == '/' && mmapIO.Open(url))
+    {
+        isMmapOpen = true;
+        ic = avformat_alloc_context();
+        ic->pb = mmapIO.GetIO();
+    }
     int re = avformat_open_input(&ic,url,0,0);
     if(re != 0 )
     {
+        //失败时ffmpeg已释放ic，自定义IO需要自己关闭
+        if(isCacheOpen)
+        {
+            ioCache.Close();
+            isCacheOpen = false;
+        }
+        if(isMmapOpen)
+        {
+            mmapIO.Close();
+            isMmapOpen = false;
+        }
         mux.unlock();
         char buf[1024] = {0};
         av_strerror(re,buf,sizeof(buf));
@@ -59,51 +144,122 @@ bool FFDemux::Open(const char *url)
         return false;
     }
     XLOGI("FFDemux open %s success!",url);
+    openMs = XNowMs() - begin;
 
-    //读取文件信息
-    re = avformat_find_stream_info(ic,0);
-    if(re != 0 )
+    //读取文件信息，有保存的记录时跳过探测
+    //校验记录要重读文件开头，只用于本地文件和块缓存，ffmpeg直接读取的网络源跳回开头要重新请求
+    begin = XNowMs();
+    isLocalRead = isCacheOpen || isMmapOpen || url[0] == '/' || !strncmp(url,"file:",5);
+    isInfoCached = isInfoCache && FFStreamInfo::Get()->Apply(ic,url,isLocalRead);
+    if(!isInfoCached && !FindStreamInfo(url))
     {
         mux.unlock();
-        char buf[1024] = {0};
-        av_strerror(re,buf,sizeof(buf));
-        XLOGE("avformat_find_stream_info %s failed!",url);
         return false;
     }
+    probeMs = XNowMs() - begin;
+    XLOGI("FFDemux open %.1f ms probe %.1f ms %s",openMs,probeMs,isInfoCached ? "cached" : "");
 
-    this->totalMs = ic->duration/(AV_TIME_BASE/1000);
+    this->totalMs = ic->duration != AV_NOPTS_VALUE ? ic->duration/(AV_TIME_BASE/1000) : 0;
+    XLOGI("total ms = %lld!",totalMs);
 
+    //音视频流只查找一次，之后GetVPara GetAPara直接返回
+    vPara = FindPara(false);
+    aPara = FindPara(true);
+
+    BuildIndex();
     mux.unlock();
-    XLOGI("total ms = %d!",totalMs);
+    return true;
+}
 
-    GetVPara();
-    GetAPara();
+bool FFDemux::FindStreamInfo(const char *url)
+{
+    if(probeSize > 0) ic->probesize = probeSize;
+    if(analyzeMs > 0) ic->max_analyze_duration = (long long)analyzeMs * (AV_TIME_BASE / 1000);
+    int re = avformat_find_stream_info(ic,0);
+
+    //限制内没有得到解码需要的参数，按默认值继续探测
+    bool isLack = false;
+    for(unsigned int i = 0; i < ic->nb_streams && re >= 0; i++)
+    {
+        AVCodecParameters *p = ic->streams[i]->codecpar;
+        if(p->codec_type == AVMEDIA_TYPE_VIDEO && (p->width <= 0 || p->format < 0))
+            isLack = true;
+        if(p->codec_type == AVMEDIA_TYPE_AUDIO && (p->sample_rate <= 0 || p->channels <= 0 || p->format < 0))
+            isLack = true;
+    }
+    if(re < 0 || isLack)
+    {
+        XLOGI("FFDemux probe %s again with default limits",url);
+        ic->probesize = 5000000;
+        ic->max_analyze_duration = 0;
+        re = avformat_find_stream_info(ic,0);
+    }
+    if(re < 0)
+    {
+        char buf[1024] = {0};
+        av_strerror(re,buf,sizeof(buf));
+        XLOGE("avformat_find_stream_info %s failed!",url);
+        return false;
+    }
+    if(isInfoCache)
+        FFStreamInfo::Get()->Save(ic,url,isLocalRead);
     return true;
 }
-//获取视频参数
-XParameter FFDemux::GetVPara()
+
+void FFDemux::BuildIndex()
 {
-    mux.lock();
-    if (!ic) {
-        mux.unlock();
-        XLOGE("GetVPara failed! ic is NULL！");
-        return XParameter();
+    keyIndex.Clear();
+    if(!ic || videoStream < 0 || videoStream >= (int)ic->nb_streams) return;
+
+    //MP4 MKV等容器打开后已有样本索引，只保留关键帧
+    //MP4的样本索引是解码时间戳，按第一个关键帧的显示时间戳（流的start_time）整体平移，
+    //重排延迟不变时换算准确，否则只是近似；MKV的索引本来就是显示时间戳，平移为0
+    AVStream *st = ic->streams[videoStream];
+    indexShift = 0;
+    bool isFirst = true;
+    for(int i = 0; i < st->nb_index_entries; i++)
+    {
+        AVIndexEntry &e = st->index_entries[i];
+        if(!(e.flags & AVINDEX_KEYFRAME)) continue;
+        if(isFirst && st->start_time != AV_NOPTS_VALUE && st->start_time > e.timestamp)
+            indexShift = st->start_time - e.timestamp;
+        isFirst = false;
+        keyIndex.Add(e.timestamp + indexShift,e.pos);
     }
-    //获取了视频流索引
-    int re = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO, -1, -1, 0, 0);
+    keyIndex.isFull = keyIndex.Size() > 0;
+    XLOGI("keyframe index %d entries, from container %d",keyIndex.Size(),keyIndex.isFull);
+}
+//查找音频或视频流，调用者加锁
+XParameter FFDemux::FindPara(bool isAudio)
+{
+    AVMediaType type = isAudio ? AVMEDIA_TYPE_AUDIO : AVMEDIA_TYPE_VIDEO;
+    int re = av_find_best_stream(ic, type, -1, -1, 0, 0);
     if (re < 0) {
-        mux.unlock();
-        XLOGE("av_find_best_stream failed!");
+        XLOGE("av_find_best_stream %s failed!", isAudio ? "audio" : "video");
+        return XParameter();
+    }
+    if (isAudio) audioStream = re;
+    else videoStream = re;
+    AVCodecParameters *&copy = isAudio ? aCodecPar : vCodecPar;
+    avcodec_parameters_free(&copy);
+    copy = avcodec_parameters_alloc();
+    if (!copy || avcodec_parameters_copy(copy, ic->streams[re]->codecpar) < 0) {
+        XLOGE("avcodec_parameters_copy %s failed!", isAudio ? "audio" : "video");
+        avcodec_parameters_free(&copy);
         return XParameter();
     }
-    videoStream = re;
     XParameter para;
-    para.para = ic->streams[re]->codecpar;
-    mux.unlock();
+    para.para = copy;
+    if (isAudio) {
+        para.channels = ic->streams[re]->codecpar->channels;
+        para.sample_rate = ic->streams[re]->codecpar->sample_rate;
+    }
+    para.timeBase.num = ic->streams[re]->time_base.num;
+    para.timeBase.den = ic->streams[re]->time_base.den;
     return para;
 }
-//获取音频参数
-XParameter FFDemux::GetAPara()
+//获取视频参数，Open时已查找
+XParameter FFDemux::GetVPara()
 {
     mux.lock();
     if (!ic) {
@@ -111,18 +267,20 @@ XParameter FFDemux::GetAPara()
         XLOGE("GetVPara failed! ic is NULL！");
         return XParameter();
     }
-    //获取了音频流索引
-    int re = av_find_best_stream(ic, AVMEDIA_TYPE_AUDIO, -1, -1, 0, 0);
-    if (re < 0) {
+    XParameter para = vPara;
+    mux.unlock();
+    return para;
+}
+//获取音频参数，Open时已查找
+XParameter FFDemux::GetAPara()
+{
+    mux.lock();
+    if (!ic) {
         mux.unlock();
-        XLOGE("av_find_best_stream failed!");
+        XLOGE("GetAPara failed! ic is NULL！");
         return XParameter();
     }
-    audioStream = re;
-    XParameter para;
-    para.para = ic->streams[re]->codecpar;
-    para.channels = ic->streams[re]->codecpar->channels;
-    para.sample_rate = ic->streams[re]->codecpar->sample_rate;
+    XParameter para = aPara;
     mux.unlock();
     return para;
 }
@@ -137,17 +295,16 @@ XData FFDemux::Read()
     }
 
     XData d;
-    AVPacket *pkt = av_packet_alloc();
+    AVPacket *pkt = XPacketPool::Get()->Alloc();
     int re = av_read_frame(ic,pkt);
     if(re != 0)
     {
         mux.unlock();
-        av_packet_free(&pkt);
+        XPacketPool::Get()->Free(&pkt);
         return XData();
     }
     //XLOGI("pack size is %d ptss %lld",pkt->size,pkt->pts);
-    d.data = (unsigned char*)pkt;
-    d.size = pkt->size;
+    d.Attach(AVPACKET_TYPE,(unsigned char*)pkt,pkt->size);
     if(pkt->stream_index == audioStream)
     {
         d.isAudio = true;
@@ -159,15 +316,23 @@ XData FFDemux::Read()
     else
     {
         mux.unlock();
-        av_packet_free(&pkt);
+        d.Drop();
         return XData();
     }
 
-    //转换pts
-    pkt->pts = pkt->pts * (1000*r2d(ic->streams[pkt->stream_index]->time_base));
-    pkt->dts = pkt->dts * (1000*r2d(ic->streams[pkt->stream_index]->time_base));
-    d.pts = (int)pkt->pts;
-    //XLOGE("demux pts %d",d.pts);
+    //保留流时间基的原始时间戳，不再转换为毫秒，packet本身交给解码器也不做修改
+    AVRational tb = ic->streams[pkt->stream_index]->time_base;
+    d.timeBase.num = tb.num;
+    d.timeBase.den = tb.den;
+    d.pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    d.dts = pkt->dts;
+
+    d.isKey = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+
+    //容器没有索引时，读取过程中补充关键帧索引
+    if(!d.isAudio && !keyIndex.isFull && d.isKey && d.pts != AV_NOPTS_VALUE)
+        keyIndex.Add(d.pts,pkt->pos);
+    //XLOGE("demux pts %lld",d.pts);
     mux.unlock();
     return d;
 }
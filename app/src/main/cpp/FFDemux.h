@@ -3,6 +3,9 @@
 
 
 #include "IDemux.h"
+#include "XKeyIndex.h"
+#include "FFIOCache.h"
+#include "FFMmapIO.h"
 #include <mutex>
 struct AVFormatContext;
 
@@ -26,7 +29,56 @@ public:
 
     FFDemux();
 
+    //视频流关键帧索引
+    XKeyIndex keyIndex;
+
+    //http https 地址通过块缓存读取（本地文件由isMmap控制），Open前设置
+    bool isIOCache = true;
+
+    //块缓存命中率和读取字节数
+    XIOStats GetIOStats();
+
+    //本地路径（/开头）通过内存映射读取，Open前设置
+    bool isMmap = true;
+
+    //探测流信息的数据量上限（字节）和时长上限（毫秒），0使用ffmpeg默认值
+    //限制内探测不到完整的参数时，按默认值再探测一次
+    int probeSize = 512 * 1024;
+    int analyzeMs = 1000;
+
+    //使用保存的流信息跳过探测（FFStreamInfo设置了目录时）
+    bool isInfoCache = true;
+
 private:
+    //块缓存IO
+    FFIOCache ioCache;
+    bool isCacheOpen = false;
+    //本地文件内存映射IO
+    FFMmapIO mmapIO;
+    bool isMmapOpen = false;
+    //源读取开头不需要网络请求（本地文件或块缓存）
+    bool isLocalRead = false;
+
+    //容器索引的时间戳是解码时间戳（MP4有B帧时早于显示时间戳），加上该值近似换算为显示时间戳
+    long long indexShift = 0;
+
+    //从容器索引建立关键帧索引，调用者加锁
+    void BuildIndex();
+
+    //探测流信息，调用者加锁
+    bool FindStreamInfo(const char *url);
+
+    //查找音频或视频流，记录流索引，调用者加锁
+    //参数复制一份交给解码器，读取线程启动后av_read_frame可能修改流的codecpar
+    XParameter FindPara(bool isAudio);
+
+    //Open时查找的音视频参数
+    XParameter vPara;
+    XParameter aPara;
+    //vPara aPara中的参数副本，Close时释放
+    AVCodecParameters *vCodecPar = 0;
+    AVCodecParameters *aCodecPar = 0;
+
     AVFormatContext *ic = 0;
     std::mutex mux;
     int audioStream = 1;
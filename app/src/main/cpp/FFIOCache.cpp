@@ -0,0 +1,417 @@
+#include "FFIOCache.h"
+#include "XDiskCache.h"
+#include "XLog.h"
+#include <cstring>
+extern "C"{
+#include <libavformat/avformat.h>
+}
+
+//avio内部读取缓冲大小
+static const int IO_BUFFER_SIZE = 32 * 1024;
+
+bool FFIOCache::Open(const char *url)
+{
+    Close();
+    isClosing = false;
+    isChanged = false;
+    this->url = url;
+
+    //只有http点播写入磁盘缓存，本地文件不需要
+    if(strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0)
+        disk = XDiskCache::Get()->Open(url, blockSize);
+    size = XDiskCache::Get()->GetSize(disk);
+
+    //磁盘缓存记录了大小，源由预读线程打开，全部已缓存时不访问网络
+    if(size < 0)
+    {
+        srcMux.lock();
+        src = OpenSrc();
+        srcMux.unlock();
+    }
+    if(size < 0 && !src)
+    {
+        XDiskCache::Get()->Close(disk);
+        disk = 0;
+        return false;
+    }
+
+    mux.lock();
+    pos = 0;
+    aheadIndex = -1;
+    stats = XIOStats();
+    mux.unlock();
+
+    unsigned char *buf = (unsigned char *)av_malloc(IO_BUFFER_SIZE);
+    io = avio_alloc_context(buf, IO_BUFFER_SIZE, 0, this, ReadCall, 0, SeekCall);
+    if(!io)
+    {
+        av_free(buf);
+        Close();
+        return false;
+    }
+    XLOGI("FFIOCache open %s size %lld disk %s", url, (long long)size, disk ? "on" : "off");
+    return XThread::Start();
+}
+
+void FFIOCache::Close()
+{
+    isClosing = true;
+    XThread::Stop();
+
+    if(io)
+    {
+        av_freep(&io->buffer);
+        avio_context_free(&io);
+    }
+    srcMux.lock();
+    if(src)
+        SrcClose(&src);
+    XDiskCache::Get()->Close(disk);
+    disk = 0;
+    srcMux.unlock();
+
+    mux.lock();
+    blocks.clear();
+    lru.clear();
+    cacheSerial++;
+    mux.unlock();
+}
+
+AVIOContext *FFIOCache::SrcOpen()
+{
+    //关闭时中断阻塞在网络读取中的调用
+    AVIOInterruptCB cb = {InterruptCall, this};
+    AVIOContext *s = 0;
+    int re = avio_open2(&s, url.c_str(), AVIO_FLAG_READ, &cb, 0);
+    if(re < 0)
+    {
+        char buf[1024] = {0};
+        av_strerror(re, buf, sizeof(buf) - 1);
+        XLOGE("FFIOCache open %s failed! %s", url.c_str(), buf);
+        return 0;
+    }
+    return s;
+}
+
+long long FFIOCache::SrcSize(AVIOContext *s)
+{
+    return avio_size(s);
+}
+
+int FFIOCache::SrcRead(AVIOContext *s, unsigned char *buf, int size)
+{
+    return avio_read(s, buf, size);
+}
+
+bool FFIOCache::SrcSeek(AVIOContext *s, long long offset)
+{
+    return avio_tell(s) == offset || avio_seek(s, offset, SEEK_SET) >= 0;
+}
+
+void FFIOCache::SrcClose(AVIOContext **s)
+{
+    avio_closep(s);
+}
+
+AVIOContext *FFIOCache::OpenSrc()
+{
+    AVIOContext *s = SrcOpen();
+    if(!s) return 0;
+    long long srcSize = SrcSize(s);
+    if(!disk)
+    {
+        size = srcSize;
+        return s;
+    }
+
+    //大小相同内容也可能已经更新，读取开头的数据比较哈希
+    unsigned char head[XDiskCache::FINGERPRINT_BYTES];
+    int n = SrcRead(s, head, sizeof(head));
+    if(n < 0) n = 0;
+    if(!SrcSeek(s, 0))
+    {
+        XLOGE("FFIOCache %s seek back failed!", url.c_str());
+        SrcClose(&s);
+        return 0;
+    }
+    bool isSame = XDiskCache::Get()->Validate(disk, srcSize, XDiskCache::Hash(head, n));
+    size = srcSize;
+    if(!isSame)
+    {
+        XLOGE("FFIOCache %s changed, drop cached blocks", url.c_str());
+        mux.lock();
+        blocks.clear();
+        lru.clear();
+        cacheSerial++;
+        if(stats.readBytes > 0) isChanged = true;
+        mux.unlock();
+    }
+    return s;
+}
+
+FFIOCache::~FFIOCache()
+{
+    Close();
+}
+
+XIOStats FFIOCache::GetStats()
+{
+    mux.lock();
+    XIOStats re = stats;
+    mux.unlock();
+    return re;
+}
+
+int FFIOCache::ReadCall(void *opaque, uint8_t *buf, int size)
+{
+    return ((FFIOCache *)opaque)->Read(buf, size);
+}
+
+int64_t FFIOCache::SeekCall(void *opaque, int64_t offset, int whence)
+{
+    return ((FFIOCache *)opaque)->Seek(offset, whence);
+}
+
+int FFIOCache::InterruptCall(void *opaque)
+{
+    return ((FFIOCache *)opaque)->isClosing ? 1 : 0;
+}
+
+int FFIOCache::CopyBlock(long long index, int offset, unsigned char *buf, int size)
+{
+    auto it = blocks.find(index);
+    if(it == blocks.end()) return -1;
+    //移到最近使用
+    lru.splice(lru.begin(), lru, it->second.lru);
+    int n = (int)it->second.data.size() - offset;
+    if(n > size) n = size;
+    if(n <= 0) return 0;
+    memcpy(buf, it->second.data.data() + offset, n);
+    return n;
+}
+
+int FFIOCache::Read(unsigned char *buf, int size)
+{
+    if(size <= 0) return 0;
+    if(isChanged) return AVERROR(EIO);
+    long long index = pos / blockSize;
+    int offset = (int)(pos % blockSize);
+
+    mux.lock();
+    int n = CopyBlock(index, offset, buf, size);
+    if(n >= 0) stats.hits++;
+    mux.unlock();
+
+    //未命中，同步读取（预读线程正在读取该块时等待其完成）
+    if(n < 0)
+    {
+        Fetch(index, false);
+        mux.lock();
+        n = CopyBlock(index, offset, buf, size);
+        mux.unlock();
+        if(n < 0) return isClosing ? AVERROR_EXIT : isChanged ? AVERROR(EIO) : AVERROR_EOF;
+    }
+    if(n == 0) return AVERROR_EOF;
+
+    pos += n;
+    mux.lock();
+    stats.readBytes += n;
+    //预读之后的块
+    aheadIndex = index + 1;
+    aheadCond.notify_one();
+    mux.unlock();
+    return n;
+}
+
+int64_t FFIOCache::Seek(int64_t offset, int whence)
+{
+    if(whence & AVSEEK_SIZE)
+        return size >= 0 ? size.load() : AVERROR(ENOSYS);
+    whence &= ~AVSEEK_FORCE;
+
+    long long p = 0;
+    switch(whence)
+    {
+        case SEEK_SET:
+            p = offset;
+            break;
+        case SEEK_CUR:
+            p = pos + offset;
+            break;
+        case SEEK_END:
+            if(size < 0) return AVERROR(ENOSYS);
+            p = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if(p < 0) return AVERROR(EINVAL);
+    pos = p;
+    return pos;
+}
+
+bool FFIOCache::Fetch(long long index, bool isAhead)
+{
+    long long offset = index * blockSize;
+    mux.lock();
+    bool has = blocks.find(index) != blocks.end();
+    int serial = cacheSerial;
+    mux.unlock();
+    if(has || isClosing || (size >= 0 && offset >= size)) return has;
+
+    //磁盘缓存，不经过源，离线或网络慢时已缓存的部分照常打开和跳转
+    std::vector<unsigned char> data(blockSize);
+    int n = XDiskCache::Get()->Read(disk, index, data.data());
+    if(n > 0)
+    {
+        data.resize(n);
+        //读取期间预读线程校验发现源已变化，磁盘记录已清空，改从源读取
+        if(Put(index, data, serial))
+        {
+            mux.lock();
+            stats.diskHits++;
+            stats.diskBytes += n;
+            if(!isAhead) stats.misses++;
+            mux.unlock();
+            return true;
+        }
+        data.resize(blockSize);
+    }
+
+    //同一时间只有一个线程读取源，等待期间其他线程可能已经读取了该块
+    //std::mutex不保证公平，解封装等待时预读让出，不在它前面连续读取多块
+    //预读线程落后，块已经在读取位置之前（可能已被淘汰），不再读取
+    if(!isAhead) demandCount++;
+    srcMux.lock();
+    if(!isAhead)
+    {
+        demandCount--;
+    }
+    else if(demandCount > 0 || offset + blockSize <= pos)
+    {
+        srcMux.unlock();
+        return false;
+    }
+    mux.lock();
+    has = blocks.find(index) != blocks.end();
+    if(has && !isAhead) stats.hits++;
+    serial = cacheSerial;
+    mux.unlock();
+    if(has || isClosing)
+    {
+        srcMux.unlock();
+        return has;
+    }
+
+    if(!src) src = OpenSrc();
+    if(!src || !SrcSeek(src, offset))
+    {
+        srcMux.unlock();
+        return false;
+    }
+    n = 0;
+    bool isEnd = false;
+    while(n < blockSize && !isClosing)
+    {
+        int re = SrcRead(src, data.data() + n, blockSize - n);
+        if(re <= 0)
+        {
+            isEnd = re == AVERROR_EOF || re == 0;
+            break;
+        }
+        n += re;
+    }
+    //读取被中断或出错，不完整的块不缓存
+    if(n <= 0 || (n < blockSize && !isEnd))
+    {
+        srcMux.unlock();
+        return false;
+    }
+    data.resize(n);
+    //释放srcMux前放入内存，等待srcMux的线程不会重复读取该块；写磁盘不持有srcMux
+    std::vector<unsigned char> save;
+    if(disk) save = data;
+    mux.lock();
+    stats.fetchBytes += n;
+    if(!isAhead) stats.misses++;
+    mux.unlock();
+    bool re = Put(index, data, serial);
+    srcMux.unlock();
+    if(disk) XDiskCache::Get()->Write(disk, index, save.data(), n);
+    return re;
+}
+
+bool FFIOCache::Put(long long index, std::vector<unsigned char> &data, int serial)
+{
+    std::lock_guard<std::mutex> lock(mux);
+    if(serial != cacheSerial) return false;
+    auto it = blocks.find(index);
+    if(it != blocks.end())
+    {
+        //两个线程同时读取了同一块，保留先放入的
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return true;
+    }
+    lru.push_front(index);
+    XBlock &b = blocks[index];
+    b.data.swap(data);
+    b.lru = lru.begin();
+    //淘汰最久未使用的块
+    while((int)blocks.size() > maxBlocks)
+    {
+        blocks.erase(lru.back());
+        lru.pop_back();
+    }
+    return true;
+}
+
+void FFIOCache::Wake()
+{
+    mux.lock();
+    aheadCond.notify_all();
+    mux.unlock();
+}
+
+//预读线程
+void FFIOCache::Main()
+{
+    //磁盘缓存有记录时源还没有打开，尽早打开校验记录是否还有效，打开失败（离线）继续使用缓存
+    //打开和校验不持有srcMux，期间解封装照常读取磁盘缓存；源变化时OpenSrc清空磁盘记录和内存中的块
+    srcMux.lock();
+    bool isOpened = src != 0;
+    srcMux.unlock();
+    if(disk && !isOpened && !isClosing)
+    {
+        AVIOContext *s = OpenSrc();
+        srcMux.lock();
+        if(!src)
+        {
+            src = s;
+            s = 0;
+        }
+        srcMux.unlock();
+        //解封装读取已经打开了源
+        if(s) SrcClose(&s);
+    }
+
+    while(!isExit)
+    {
+        std::unique_lock<std::mutex> lock(mux);
+        aheadCond.wait(lock, [this] { return aheadIndex >= 0 || isExit; });
+        if(isExit) break;
+        long long start = aheadIndex;
+        aheadIndex = -1;
+        lock.unlock();
+
+        for(int i = 0; i < readAhead && !isExit; i++)
+        {
+            if(!Fetch(start + i, true)) break;
+
+            //解封装跳到了别处，按新的位置预读
+            mux.lock();
+            bool isJump = aheadIndex >= 0 && (aheadIndex < start || aheadIndex > start + readAhead);
+            mux.unlock();
+            if(isJump) break;
+        }
+    }
+}
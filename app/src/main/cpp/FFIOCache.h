@@ -0,0 +1,141 @@
+#ifndef XPLAY_FFIOCACHE_H
+#define XPLAY_FFIOCACHE_H
+
+#include "XThread.h"
+#include <cstdint>
+#include <string>
+#include <map>
+#include <list>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+struct AVIOContext;
+struct XDiskEntry;
+
+//块缓存统计
+struct XIOStats
+{
+    //解封装读取命中与未命中的块数
+    long long hits = 0;
+    long long misses = 0;
+    //从源读取的字节数（含预读）
+    long long fetchBytes = 0;
+    //从磁盘缓存读取的块数和字节数（含预读）
+    long long diskHits = 0;
+    long long diskBytes = 0;
+    //解封装读取的字节数
+    long long readBytes = 0;
+
+    double HitRate()
+    {
+        long long n = hits + misses;
+        return n > 0 ? (double)hits / n : 0;
+    }
+};
+
+//带块缓存的AVIOContext，交给avformat_open_input作为自定义IO
+//源数据按固定大小的块读取，LRU淘汰，后台线程顺序预读当前位置之后的块
+//moov在文件末尾的MP4来回读取头尾时，已读过的块不再从网络读取
+//http源在开启XDiskCache时，块同时写入磁盘，再次打开时已下载的块从磁盘读取
+class FFIOCache: public XThread
+{
+public:
+    //打开源（ffmpeg支持的协议，播放器只用于http）并启动预读线程
+    bool Open(const char *url);
+
+    //停止预读线程，关闭源和AVIOContext
+    void Close();
+
+    //自定义IO，Open成功后有效，由Close释放
+    AVIOContext *GetIO() { return io; }
+
+    XIOStats GetStats();
+
+    //以下在Open前设置
+    //块大小（字节）
+    int blockSize = 256 * 1024;
+    //最多缓存的块数
+    int maxBlocks = 64;
+    //顺序读取时预读的块数
+    int readAhead = 4;
+
+    virtual ~FFIOCache();
+
+protected:
+    virtual void Main();
+    virtual void Wake();
+
+    static int ReadCall(void *opaque, uint8_t *buf, int size);
+    static int64_t SeekCall(void *opaque, int64_t offset, int whence);
+    static int InterruptCall(void *opaque);
+
+    int Read(unsigned char *buf, int size);
+    int64_t Seek(int64_t offset, int whence);
+
+    //从源读取一块放入缓存，已缓存直接返回true，isAhead为预读
+    //解封装读取优先，预读遇到解封装在等待源时放弃返回false
+    bool Fetch(long long index, bool isAhead);
+
+    //打开源并返回，失败返回空，不访问src，调用者不需要持有srcMux
+    //磁盘缓存有记录时由预读线程打开，校验源的大小和开头数据，
+    //与磁盘缓存的记录不同时清空磁盘记录和内存中的块
+    AVIOContext *OpenSrc();
+
+    //源的读写，默认通过avio打开url，主机测试替换为内存中的数据
+    //SrcOpen失败返回空，SrcRead与avio_read相同，SrcSeek跳到offset（已在该位置不跳转）
+    //基类析构时Close只调用基类的实现，替换了源的子类在自己的析构中先Close
+    virtual AVIOContext *SrcOpen();
+    virtual long long SrcSize(AVIOContext *s);
+    virtual int SrcRead(AVIOContext *s, unsigned char *buf, int size);
+    virtual bool SrcSeek(AVIOContext *s, long long offset);
+    virtual void SrcClose(AVIOContext **s);
+
+    //放入内存缓存，淘汰最久未使用的块
+    //serial为读取前的cacheSerial，期间缓存被清空（源已变化）则不放入，返回false
+    bool Put(long long index, std::vector<unsigned char> &data, int serial);
+
+    //复制缓存中的块数据，块不在缓存返回-1（调用者加锁）
+    int CopyBlock(long long index, int offset, unsigned char *buf, int size);
+
+    struct XBlock
+    {
+        std::vector<unsigned char> data;
+        std::list<long long>::iterator lru;
+    };
+    std::map<long long, XBlock> blocks;
+    //最近使用的在前
+    std::list<long long> lru;
+    //源变化清空缓存时加一，丢弃清空前开始读取的块
+    int cacheSerial = 0;
+    std::mutex mux;
+
+    //源IO，只在持有srcMux时读取和设置
+    std::string url;
+    AVIOContext *src = 0;
+    std::mutex srcMux;
+    //等待srcMux的解封装读取数，预读线程拿到srcMux后发现有等待则让出
+    std::atomic<int> demandCount{0};
+    //源总大小，未知为-1（预读线程打开源时更新，解封装线程读取）
+    std::atomic<long long> size{-1};
+
+    //磁盘缓存，未开启为空
+    XDiskEntry *disk = 0;
+
+    AVIOContext *io = 0;
+    //解封装读取位置
+    std::atomic<long long> pos{0};
+
+    //预读请求，从该块开始
+    long long aheadIndex = -1;
+    std::condition_variable aheadCond;
+
+    std::atomic<bool> isClosing{false};
+    //已经读出缓存的旧数据后发现源变化，之后的读取返回错误，不把新旧数据混在一起
+    std::atomic<bool> isChanged{false};
+    XIOStats stats;
+};
+
+
+#endif //XPLAY_FFIOCACHE_H
@@ -0,0 +1,194 @@
+#include "FFMmapIO.h"
+#include "XLog.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+extern "C"{
+#include <libavformat/avformat.h>
+}
+
+//avio内部读取缓冲大小，大于它的读取直接复制到调用者的缓冲
+static const int IO_BUFFER_SIZE = 32 * 1024;
+
+bool FFMmapIO::Open(const char *path)
+{
+    Close();
+    fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        XLOGE("FFMmapIO open %s failed!", path);
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+    {
+        Close();
+        return false;
+    }
+    void *p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED || (long long)(size_t)st.st_size != st.st_size)
+    {
+        if(p != MAP_FAILED) munmap(p, (size_t)st.st_size);
+        XLOGE("FFMmapIO mmap %s %lld bytes failed!", path, (long long)st.st_size);
+        Close();
+        return false;
+    }
+    data = (unsigned char *)p;
+    mapSize = st.st_size;
+    size = st.st_size;
+    pos = 0;
+    adviseStart = 0;
+    adviseEnd = 0;
+    releaseEnd = 0;
+    isShrunk = false;
+    stats = XMmapStats();
+    madvise(data, (size_t)size, MADV_SEQUENTIAL);
+    Advise(0);
+
+    unsigned char *buf = (unsigned char *)av_malloc(IO_BUFFER_SIZE);
+    io = avio_alloc_context(buf, IO_BUFFER_SIZE, 0, this, ReadCall, 0, SeekCall);
+    if(!io)
+    {
+        av_free(buf);
+        Close();
+        return false;
+    }
+    XLOGI("FFMmapIO open %s size %lld", path, size);
+    return true;
+}
+
+void FFMmapIO::Close()
+{
+    if(io)
+    {
+        av_freep(&io->buffer);
+        avio_context_free(&io);
+    }
+    if(data)
+    {
+        munmap(data, (size_t)mapSize);
+        data = 0;
+    }
+    if(fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    mapSize = 0;
+    size = 0;
+}
+
+FFMmapIO::~FFMmapIO()
+{
+    Close();
+}
+
+int FFMmapIO::ReadCall(void *opaque, uint8_t *buf, int size)
+{
+    return ((FFMmapIO *)opaque)->Read(buf, size);
+}
+
+int64_t FFMmapIO::SeekCall(void *opaque, int64_t offset, int whence)
+{
+    return ((FFMmapIO *)opaque)->Seek(offset, whence);
+}
+
+bool FFMmapIO::CheckSize()
+{
+    if(isShrunk) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size >= size) return true;
+    //之后不再访问映射
+    XLOGE("FFMmapIO file shrank %lld -> %lld, fall back to pread", size, (long long)st.st_size);
+    size = st.st_size;
+    isShrunk = true;
+    return false;
+}
+
+void FFMmapIO::Advise(long long from)
+{
+    if(!CheckSize()) return;
+    //madvise需要页对齐
+    long long page = sysconf(_SC_PAGESIZE);
+    long long start = from / page * page;
+    long long end = from + aheadBytes;
+    if(end > size) end = size;
+    if(start >= end) return;
+    madvise(data + start, (size_t)(end - start), MADV_WILLNEED);
+    adviseStart = from;
+    adviseEnd = end;
+    stats.advises++;
+
+    //读取位置后方一个窗口之前的映射释放，减少常驻内存（页缓存还在，再读取时重新映射）
+    long long behind = (from - aheadBytes) / page * page;
+    if(releaseEnd > start) releaseEnd = start;
+    if(behind > releaseEnd)
+    {
+        madvise(data + releaseEnd, (size_t)(behind - releaseEnd), MADV_DONTNEED);
+        releaseEnd = behind;
+    }
+}
+
+int FFMmapIO::Read(unsigned char *buf, int size)
+{
+    if(pos >= this->size) return AVERROR_EOF;
+    long long n = this->size - pos;
+    if(n > size) n = size;
+    //读取位置在窗口之外，或进入窗口的后半段，检查大小并从读取位置提示新的窗口
+    bool isOut = pos < adviseStart || pos >= adviseEnd;
+    bool isNear = pos + n + aheadBytes / 2 > adviseEnd && adviseEnd < this->size;
+    if(!isShrunk && (isOut || isNear))
+        Advise(pos);
+
+    if(isShrunk)
+    {
+        if(pos >= this->size) return AVERROR_EOF;
+        if(n > this->size - pos) n = this->size - pos;
+        long long re = pread(fd, buf, (size_t)n, pos);
+        if(re <= 0) return AVERROR_EOF;
+        n = re;
+        stats.preads++;
+    }
+    else
+    {
+        //只复制检查过大小的范围
+        if(pos + n > adviseEnd) n = adviseEnd - pos;
+        memcpy(buf, data + pos, (size_t)n);
+    }
+    pos += n;
+    stats.readBytes += n;
+    stats.reads++;
+    return (int)n;
+}
+
+int64_t FFMmapIO::Seek(int64_t offset, int whence)
+{
+    if(whence & AVSEEK_SIZE)
+        return size;
+    whence &= ~AVSEEK_FORCE;
+
+    long long p = 0;
+    switch(whence)
+    {
+        case SEEK_SET:
+            p = offset;
+            break;
+        case SEEK_CUR:
+            p = pos + offset;
+            break;
+        case SEEK_END:
+            p = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if(p < 0) return AVERROR(EINVAL);
+    //跳出已提示的窗口，从新位置提示
+    if(!isShrunk && (p < adviseStart || p > adviseEnd))
+        Advise(p);
+    pos = p;
+    stats.seeks++;
+    return pos;
+}
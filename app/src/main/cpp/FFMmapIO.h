@@ -0,0 +1,78 @@
+#ifndef XPLAY_FFMMAPIO_H
+#define XPLAY_FFMMAPIO_H
+
+#include <cstdint>
+
+struct AVIOContext;
+
+//本地文件内存映射统计
+struct XMmapStats
+{
+    //解封装读取的字节数和次数
+    long long readBytes = 0;
+    long long reads = 0;
+    long long seeks = 0;
+    //madvise预读提示次数
+    long long advises = 0;
+    //文件变小后改用pread读取的次数
+    long long preads = 0;
+};
+
+//本地文件的内存映射AVIOContext，交给avformat_open_input作为自定义IO
+//读取直接从映射复制，不经过read系统调用，在读取位置前方按窗口提示内核预读
+//主要减少系统调用次数，页缓存命中时CPU占用与read()相当（缺页代替了复制）
+//文件被截断后访问映射会触发SIGBUS：每个预读窗口前fstat检查大小，只从检查过的窗口复制，
+//发现变小后改用pread读取；窗口内（检查之后）被截断仍无法避免，只用于本地媒体文件
+class FFMmapIO
+{
+public:
+    //映射文件，失败（如32位进程映射超大文件）返回false，由调用者回退到普通读取
+    bool Open(const char *path);
+
+    void Close();
+
+    //自定义IO，Open成功后有效，由Close释放
+    AVIOContext *GetIO() { return io; }
+
+    long long Size() { return size; }
+
+    XMmapStats GetStats() { return stats; }
+
+    //预读窗口（字节），读取位置进入窗口后半段时提示下一窗口，Open前设置
+    long long aheadBytes = 4 * 1024 * 1024;
+
+    ~FFMmapIO();
+
+protected:
+    static int ReadCall(void *opaque, uint8_t *buf, int size);
+    static int64_t SeekCall(void *opaque, int64_t offset, int whence);
+
+    int Read(unsigned char *buf, int size);
+    int64_t Seek(int64_t offset, int whence);
+
+    //检查文件大小后提示内核预读 [from, from + aheadBytes)，释放读取位置后方较远的映射
+    void Advise(long long from);
+
+    //文件变小时改用pread，返回false
+    bool CheckSize();
+
+    unsigned char *data = 0;
+    //映射的大小，munmap使用
+    long long mapSize = 0;
+    //当前文件大小，截断后变小
+    long long size = 0;
+    long long pos = 0;
+    //检查大小后已提示预读的范围，只从这个范围复制
+    long long adviseStart = 0;
+    long long adviseEnd = 0;
+    //已释放映射的位置之前
+    long long releaseEnd = 0;
+    //保持打开，用于检查大小和截断后读取
+    int fd = -1;
+    bool isShrunk = false;
+    AVIOContext *io = 0;
+    XMmapStats stats;
+};
+
+
+#endif //XPLAY_FFMMAPIO_H
@@ -2,6 +2,7 @@
 #include "FFDemux.h"
 #include "FFdecode.h"
 #include "FFResample.h"
+#include "WSOLAStretch.h"
 #include "GLVideoView.h"
 #include "SLAudioPlay.h"
 
@@ -23,6 +24,12 @@ IResample *FFPlayerBuilder::CreateResample()
     return ff;
 }
 
+IStretch *FFPlayerBuilder::CreateStretch()
+{
+    IStretch *ff = new WSOLAStretch();
+    return ff;
+}
+
 IVideoView *FFPlayerBuilder::CreateVideoView()
 {
     IVideoView *ff = new GLVideoView();
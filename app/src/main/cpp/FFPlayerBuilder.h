@@ -17,6 +17,7 @@ protected:
     virtual IDemux *CreateDemux();
     virtual IDecode *CreateDecode();
     virtual IResample *CreateResample();
+    virtual IStretch *CreateStretch();
     virtual IVideoView *CreateVideoView();
     virtual IAudioPlay *CreateAudioPlay();
     virtual IPlayer *CreatePlayer(unsigned char index=0);
@@ -52,6 +52,10 @@ bool FFResample::Open(XParameter in, XParameter out) {
     outChannels = in.para->channels;  // 输出声道数
     outFormat = AV_SAMPLE_FMT_S16;    // 输出采样格式
 
+    // 5. 按输出格式设置PCM缓冲块大小(每帧样本数未知时按4096估算，超出时缓冲池自动扩大)
+    int frameSize = in.para->frame_size > 0 ? in.para->frame_size : 4096;
+    pool.SetBlockSize(outChannels * frameSize * av_get_bytes_per_sample((AVSampleFormat)outFormat));
+
     XLOGI("音频重采样器初始化成功!");
     mux.unlock();  // 解锁
     return true;
@@ -82,9 +86,12 @@ XData FFResample::Resample(XData indata) {
         return XData();
     }
 
-    // 分配输出缓冲区
+    // 从缓冲池取出输出缓冲区
     XData out;
-    out.Alloc(outsize);
+    if (!out.Alloc(&pool, outsize)) {
+        mux.unlock();
+        return XData();
+    }
 
     // 设置输出缓冲区指针数组
     uint8_t *outArr[2] = {0};
@@ -107,6 +114,8 @@ XData FFResample::Resample(XData indata) {
 
     // 保存时间戳
     out.pts = indata.pts;
+    out.dts = indata.dts;
+    out.timeBase = indata.timeBase;
 
     mux.unlock();  // 解锁
     return out;
@@ -3,6 +3,7 @@
 
 
 #include "IResample.h"
+#include "XBufferPool.h"
 struct SwrContext;
 class FFResample: public IResample
 {
@@ -13,6 +14,8 @@ public:
 protected:
     SwrContext *actx = 0;
     std::mutex mux;
+    //输出PCM缓冲池，消费后归还
+    XBufferPool pool;
 
 };
 
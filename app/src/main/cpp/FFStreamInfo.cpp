@@ -0,0 +1,283 @@
+#include "FFStreamInfo.h"
+#include "XDiskCache.h"
+#include "XLog.h"
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+extern "C"{
+#include <libavformat/avformat.h>
+}
+
+static const long long INFO_MAGIC = 0x32464e4958LL; //"XINF2"
+
+//每个流保存的参数下标
+enum
+{
+    I_TYPE, I_CODEC, I_TAG, I_FORMAT, I_BITRATE, I_PROFILE, I_LEVEL,
+    I_WIDTH, I_HEIGHT, I_SAR_NUM, I_SAR_DEN,
+    I_RATE, I_CHANNELS, I_LAYOUT, I_FRAMESIZE,
+    I_FPS_NUM, I_FPS_DEN, I_RFPS_NUM, I_RFPS_DEN,
+    I_EXTRA, I_COUNT
+};
+
+//按顺序读取文件内容
+struct XReader
+{
+    const std::vector<unsigned char> &buf;
+    size_t pos = 0;
+    XReader(const std::vector<unsigned char> &b) : buf(b) {}
+    bool Read(void *d, size_t n)
+    {
+        if(pos + n > buf.size()) return false;
+        memcpy(d, buf.data() + pos, n);
+        pos += n;
+        return true;
+    }
+    bool Read(long long &v) { return Read(&v, sizeof(v)); }
+};
+
+static bool ReadFile(const std::string &path, std::vector<unsigned char> &buf)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if(!fp) return false;
+    unsigned char tmp[4096];
+    size_t n = 0;
+    while((n = fread(tmp, 1, sizeof(tmp), fp)) > 0)
+        buf.insert(buf.end(), tmp, tmp + n);
+    fclose(fp);
+    return !buf.empty();
+}
+
+//头部有完整流参数的容器（MP4 MKV），跳过探测只少了估算时长等，不影响解码
+//TS FLV 裸流要靠探测读取数据包建立解析器和起始时间，不使用保存的信息
+static bool IsGlobalHeader(AVFormatContext *ic)
+{
+    const char *name = ic->iformat ? ic->iformat->name : 0;
+    return name && (strstr(name, "mov") || strstr(name, "matroska"));
+}
+
+//源的标识，大小、本地文件的修改时间、开头数据的哈希都相同才认为是同一文件
+struct XSourceId
+{
+    long long size = -1;
+    long long mtime = 0;
+    long long fingerprint = 0;
+};
+
+//读取源的标识，直播（不能seek）返回false
+static bool SourceId(AVFormatContext *ic, const char *url, XSourceId &id)
+{
+    if(!ic->pb || (ic->pb->seekable & AVIO_SEEKABLE_NORMAL) == 0) return false;
+    id.size = avio_size(ic->pb);
+    if(id.size < 0) return false;
+
+    const char *path = strncmp(url, "file:", 5) == 0 ? url + 5 : url;
+    struct stat st;
+    if(path[0] == '/' && stat(path, &st) == 0)
+        id.mtime = (long long)st.st_mtime;
+
+    //读取开头的数据后恢复读取位置；只对本地文件和块缓存调用，
+    //moov在末尾时开头已不在avio的缓冲中，跳回开头也不需要网络请求
+    long long pos = avio_tell(ic->pb);
+    unsigned char head[XDiskCache::FINGERPRINT_BYTES];
+    if(avio_seek(ic->pb, 0, SEEK_SET) < 0) return false;
+    int n = avio_read(ic->pb, head, sizeof(head));
+    if(avio_seek(ic->pb, pos, SEEK_SET) < 0 || n <= 0) return false;
+    id.fingerprint = (long long)XDiskCache::Hash(head, n);
+    return true;
+}
+
+//头部没有的参数用保存的值补全
+template <typename T>
+static void Fill(T &dst, long long v, T none)
+{
+    if(dst == none) dst = (T)v;
+}
+
+bool FFStreamInfo::SetDir(const char *dir)
+{
+    std::lock_guard<std::mutex> lock(mux);
+    this->dir.clear();
+    if(!dir || !dir[0]) return true;
+    if(mkdir(dir, 0700) != 0 && errno != EEXIST)
+    {
+        XLOGE("FFStreamInfo mkdir %s failed!", dir);
+        return false;
+    }
+    this->dir = dir;
+    return true;
+}
+
+bool FFStreamInfo::Apply(AVFormatContext *ic, const char *url, bool isLocalRead)
+{
+    if(!ic || !url || !isLocalRead || !IsGlobalHeader(ic)) return false;
+    std::vector<unsigned char> buf;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mux);
+        if(dir.empty()) return false;
+        path = dir + "/" + XDiskCache::UrlKey(url) + ".info";
+        if(!ReadFile(path, buf)) return false;
+    }
+
+    XReader r(buf);
+    long long magic = 0, duration = 0, count = 0, urlLen = 0;
+    XSourceId savedId;
+    if(!r.Read(magic) || magic != INFO_MAGIC || !r.Read(savedId.size) || !r.Read(savedId.mtime)
+       || !r.Read(savedId.fingerprint) || !r.Read(duration)
+       || !r.Read(count) || !r.Read(urlLen) || urlLen < 0 || urlLen > (long long)buf.size())
+        return false;
+    std::string saved(urlLen, 0);
+    if(!r.Read(&saved[0], urlLen) || saved != url) return false;
+
+    //流的数量、大小、修改时间或开头数据变化，文件已经不同
+    XSourceId id;
+    if(count != ic->nb_streams || !SourceId(ic, url, id) || id.size != savedId.size
+       || id.mtime != savedId.mtime || id.fingerprint != savedId.fingerprint)
+        return false;
+
+    std::vector<std::vector<long long> > vals(count, std::vector<long long>(I_COUNT));
+    std::vector<std::vector<unsigned char> > extras(count);
+    for(int i = 0; i < count; i++)
+    {
+        if(!r.Read(vals[i].data(), I_COUNT * sizeof(long long))) return false;
+        long long n = vals[i][I_EXTRA];
+        if(n < 0 || n > (long long)buf.size()) return false;
+        extras[i].resize(n);
+        if(!r.Read(extras[i].data(), n)) return false;
+
+        AVCodecParameters *p = ic->streams[i]->codecpar;
+        if(p->codec_type != vals[i][I_TYPE]) return false;
+        if(p->codec_id != AV_CODEC_ID_NONE && p->codec_id != vals[i][I_CODEC]) return false;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        AVStream *st = ic->streams[i];
+        AVCodecParameters *p = st->codecpar;
+        long long *v = vals[i].data();
+        Fill(p->codec_id, v[I_CODEC], AV_CODEC_ID_NONE);
+        Fill(p->codec_tag, v[I_TAG], 0u);
+        Fill(p->format, v[I_FORMAT], -1);
+        Fill(p->bit_rate, v[I_BITRATE], (int64_t)0);
+        Fill(p->profile, v[I_PROFILE], FF_PROFILE_UNKNOWN);
+        Fill(p->level, v[I_LEVEL], FF_LEVEL_UNKNOWN);
+        Fill(p->width, v[I_WIDTH], 0);
+        Fill(p->height, v[I_HEIGHT], 0);
+        if(p->sample_aspect_ratio.num == 0)
+            p->sample_aspect_ratio = av_make_q((int)v[I_SAR_NUM], (int)v[I_SAR_DEN]);
+        Fill(p->sample_rate, v[I_RATE], 0);
+        Fill(p->channels, v[I_CHANNELS], 0);
+        Fill(p->channel_layout, v[I_LAYOUT], (uint64_t)0);
+        Fill(p->frame_size, v[I_FRAMESIZE], 0);
+        if(st->avg_frame_rate.num == 0)
+            st->avg_frame_rate = av_make_q((int)v[I_FPS_NUM], (int)v[I_FPS_DEN]);
+        if(st->r_frame_rate.num == 0)
+            st->r_frame_rate = av_make_q((int)v[I_RFPS_NUM], (int)v[I_RFPS_DEN]);
+        if(p->extradata_size == 0 && !extras[i].empty())
+        {
+            int n = (int)extras[i].size();
+            p->extradata = (uint8_t *)av_mallocz(n + AV_INPUT_BUFFER_PADDING_SIZE);
+            if(!p->extradata) return false;
+            memcpy(p->extradata, extras[i].data(), n);
+            p->extradata_size = n;
+        }
+    }
+    if(ic->duration == AV_NOPTS_VALUE)
+        ic->duration = duration;
+    //更新修改时间，数量超出时最近使用的保留
+    utime(path.c_str(), 0);
+    return true;
+}
+
+void FFStreamInfo::Save(AVFormatContext *ic, const char *url, bool isLocalRead)
+{
+    XSourceId id;
+    if(!ic || !url || !isLocalRead || !IsGlobalHeader(ic) || !SourceId(ic, url, id)) return;
+
+    std::vector<unsigned char> buf;
+    auto put = [&buf](const void *d, size_t n) {
+        buf.insert(buf.end(), (const unsigned char *)d, (const unsigned char *)d + n);
+    };
+    long long urlLen = (long long)strlen(url);
+    long long count = ic->nb_streams;
+    long long duration = ic->duration;
+    put(&INFO_MAGIC, sizeof(INFO_MAGIC));
+    put(&id.size, sizeof(id.size));
+    put(&id.mtime, sizeof(id.mtime));
+    put(&id.fingerprint, sizeof(id.fingerprint));
+    put(&duration, sizeof(duration));
+    put(&count, sizeof(count));
+    put(&urlLen, sizeof(urlLen));
+    put(url, urlLen);
+    for(int i = 0; i < count; i++)
+    {
+        AVStream *st = ic->streams[i];
+        AVCodecParameters *p = st->codecpar;
+        long long v[I_COUNT] = {0};
+        v[I_TYPE] = p->codec_type;
+        v[I_CODEC] = p->codec_id;
+        v[I_TAG] = p->codec_tag;
+        v[I_FORMAT] = p->format;
+        v[I_BITRATE] = p->bit_rate;
+        v[I_PROFILE] = p->profile;
+        v[I_LEVEL] = p->level;
+        v[I_WIDTH] = p->width;
+        v[I_HEIGHT] = p->height;
+        v[I_SAR_NUM] = p->sample_aspect_ratio.num;
+        v[I_SAR_DEN] = p->sample_aspect_ratio.den;
+        v[I_RATE] = p->sample_rate;
+        v[I_CHANNELS] = p->channels;
+        v[I_LAYOUT] = (long long)p->channel_layout;
+        v[I_FRAMESIZE] = p->frame_size;
+        v[I_FPS_NUM] = st->avg_frame_rate.num;
+        v[I_FPS_DEN] = st->avg_frame_rate.den;
+        v[I_RFPS_NUM] = st->r_frame_rate.num;
+        v[I_RFPS_DEN] = st->r_frame_rate.den;
+        v[I_EXTRA] = p->extradata ? p->extradata_size : 0;
+        put(v, sizeof(v));
+        put(p->extradata, v[I_EXTRA]);
+    }
+
+    std::lock_guard<std::mutex> lock(mux);
+    if(dir.empty()) return;
+    std::string path = dir + "/" + XDiskCache::UrlKey(url) + ".info";
+    std::string tmp = path + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if(!fp) return;
+    bool re = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    re = fclose(fp) == 0 && re;
+    if(!re || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmp.c_str());
+        return;
+    }
+    Trim();
+}
+
+void FFStreamInfo::Trim()
+{
+    DIR *d = opendir(dir.c_str());
+    if(!d) return;
+    std::vector<std::pair<long long, std::string> > files;
+    while(dirent *ent = readdir(d))
+    {
+        std::string name = ent->d_name;
+        if(name.size() < 5 || name.compare(name.size() - 5, 5, ".info") != 0) continue;
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if(stat(path.c_str(), &st) == 0)
+            files.push_back(std::make_pair((long long)st.st_mtime, path));
+    }
+    closedir(d);
+    if((int)files.size() <= maxEntries) return;
+    std::sort(files.begin(), files.end());
+    for(int i = 0; i < (int)files.size() - maxEntries; i++)
+        unlink(files[i].second.c_str());
+}
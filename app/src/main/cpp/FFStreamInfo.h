@@ -0,0 +1,46 @@
+#ifndef XPLAY_FFSTREAMINFO_H
+#define XPLAY_FFSTREAMINFO_H
+
+#include <string>
+#include <mutex>
+
+struct AVFormatContext;
+
+//按url持久化的流信息（线程安全）
+//保存avformat_find_stream_info得到的流参数和extradata，再次打开时直接填入，跳过探测
+//只用于头部有完整流参数的MP4 MKV，按大小、本地文件修改时间和开头数据的哈希判断文件是否变化
+//重读开头数据需要源可以不经过网络请求跳转（本地文件、块缓存），其他源不使用
+class FFStreamInfo
+{
+public:
+    static FFStreamInfo *Get()
+    {
+        static FFStreamInfo info;
+        return &info;
+    }
+
+    //保存目录，不存在时创建，为空关闭
+    bool SetDir(const char *dir);
+
+    //用保存的信息补全avformat_open_input打开的流参数，isLocalRead为源读取开头不需要网络请求
+    //不是MP4 MKV、不是isLocalRead、没有记录，或流的数量、编码、文件标识与记录不同时返回false，需要探测
+    bool Apply(AVFormatContext *ic, const char *url, bool isLocalRead);
+
+    //探测完成后保存，直播（大小未知）、不是isLocalRead和其他容器不保存
+    void Save(AVFormatContext *ic, const char *url, bool isLocalRead);
+
+    //最多保存的文件数，超出删除最久未修改的
+    int maxEntries = 256;
+
+protected:
+    FFStreamInfo(){}
+
+    //删除超出数量的旧文件（调用者加锁）
+    void Trim();
+
+    std::string dir;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_FFSTREAMINFO_H
@@ -0,0 +1,289 @@
+#include "FFThumbnail.h"
+#include "FFDemux.h"
+#include "FFDecode.h"
+#include "XThread.h"
+#include "XClock.h"
+#include "XLog.h"
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+extern "C"{
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+//缩略图工作线程，各自打开文件和解码器
+class FFThumbWorker: public XThread
+{
+public:
+    FFThumbWorker(FFThumbnail *owner, const char *url, int lowres) : owner(owner), url(url)
+    {
+        decode.isKeyOnly = true;
+        decode.lowres = lowres;
+        //多个工作线程并行，每个解码器单线程，避免帧线程延迟输出
+        decode.threadCount = 1;
+    }
+
+    virtual void Main()
+    {
+        if(!demux.Open(url.c_str()) || !decode.Open(demux.GetVPara()))
+        {
+            XLOGE("FFThumbWorker open %s failed!", url.c_str());
+            return;
+        }
+        std::vector<unsigned char> rgba(owner->tileW * owner->tileH * 4);
+        while(!isExit)
+        {
+            int index = owner->Take(isExit);
+            if(index < 0) break;
+            bool re = Make(index, rgba.data());
+            owner->Finish(index, re ? rgba.data() : 0);
+        }
+        if(sws)
+        {
+            sws_freeContext(sws);
+            sws = 0;
+        }
+        decode.Close();
+        demux.Close();
+    }
+
+protected:
+    virtual void Wake()
+    {
+        owner->WakeAll();
+    }
+
+    //跳到第index张位置之前的关键帧（Seek向前查找），解码该关键帧并缩放
+    bool Make(int index, unsigned char *rgba)
+    {
+        demux.Seek((index + 0.5) / owner->count);
+        decode.Clear();
+        for(int i = 0; i < maxPackets && !isExit; i++)
+        {
+            XData pkt = demux.Read();
+            if(pkt.size <= 0) break;
+            //非关键帧不送入解码器
+            if(pkt.isAudio || !pkt.isKey)
+            {
+                pkt.Drop();
+                continue;
+            }
+            decode.SendPacket(pkt);
+            pkt.Drop();
+
+            //有帧重排延迟的解码器，送入空包取出关键帧
+            XData frame = decode.RecvFrame();
+            if(!frame.data && decode.Drain())
+            {
+                frame = decode.RecvFrame();
+                decode.Clear();
+            }
+            if(!frame.data) continue;
+            return Scale((AVFrame *)frame.data, rgba);
+        }
+        return false;
+    }
+
+    bool Scale(AVFrame *frame, unsigned char *rgba)
+    {
+        sws = sws_getCachedContext(sws,
+                                   frame->width, frame->height, (AVPixelFormat)frame->format,
+                                   owner->tileW, owner->tileH, AV_PIX_FMT_RGBA,
+                                   SWS_FAST_BILINEAR, 0, 0, 0);
+        if(!sws) return false;
+        uint8_t *data[1] = {rgba};
+        int lines[1] = {owner->tileW * 4};
+        return sws_scale(sws, frame->data, frame->linesize, 0, frame->height, data, lines) > 0;
+    }
+
+    //一张缩略图最多读取的包数，超出视为失败
+    int maxPackets = 500;
+    FFThumbnail *owner;
+    std::string url;
+    FFDemux demux;
+    FFDecode decode;
+    SwsContext *sws = 0;
+};
+
+bool FFThumbnail::Open(const char *url, int count, int tileW, int tileH, int cols)
+{
+    Close();
+    if(!url || count <= 0 || tileW <= 0 || tileH <= 0 || cols <= 0)
+    {
+        XLOGE("FFThumbnail open failed! count %d tile %dx%d", count, tileW, tileH);
+        return false;
+    }
+    mux.lock();
+    this->count = count;
+    this->tileW = tileW;
+    this->tileH = tileH;
+    this->cols = cols;
+    rows = (count + cols - 1) / cols;
+    sprite.assign(SpriteWidth() * SpriteHeight() * 4, 0);
+    states.assign(count, 0);
+    focus = 0;
+    BuildHeap();
+    doneCount = 0;
+    beginMs = XNowMs();
+    lastMs = beginMs;
+    mux.unlock();
+
+    for(int i = 0; i < workers; i++)
+    {
+        FFThumbWorker *th = new FFThumbWorker(this, url, lowres);
+        threads.push_back(th);
+        th->Start();
+    }
+    return true;
+}
+
+void FFThumbnail::Close()
+{
+    for(FFThumbWorker *th : threads)
+    {
+        th->Stop();
+        delete th;
+    }
+    threads.clear();
+
+    mux.lock();
+    heap.clear();
+    states.clear();
+    sprite.clear();
+    count = 0;
+    mux.unlock();
+}
+
+FFThumbnail::~FFThumbnail()
+{
+    Close();
+}
+
+void FFThumbnail::BuildHeap()
+{
+    heap.clear();
+    for(int i = 0; i < count; i++)
+    {
+        if(states[i] == 0)
+            heap.push_back(i);
+    }
+    int f = focus;
+    std::make_heap(heap.begin(), heap.end(), [f](int a, int b) {
+        return std::abs(a - f) > std::abs(b - f);
+    });
+}
+
+void FFThumbnail::SetFocus(double pos)
+{
+    mux.lock();
+    if(count <= 0)
+    {
+        mux.unlock();
+        return;
+    }
+    int f = (int)(pos * count);
+    if(f < 0) f = 0;
+    if(f >= count) f = count - 1;
+    if(f != focus)
+    {
+        focus = f;
+        BuildHeap();
+    }
+    mux.unlock();
+}
+
+int FFThumbnail::Take(std::atomic<bool> &isExit)
+{
+    std::unique_lock<std::mutex> lock(mux);
+    while(!isExit)
+    {
+        int f = focus;
+        auto cmp = [f](int a, int b) {
+            return std::abs(a - f) > std::abs(b - f);
+        };
+        while(!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            int index = heap.back();
+            heap.pop_back();
+            if(states[index] != 0) continue;
+            states[index] = 1;
+            return index;
+        }
+        cond.wait(lock);
+    }
+    return -1;
+}
+
+void FFThumbnail::Finish(int index, const unsigned char *rgba)
+{
+    mux.lock();
+    if(index >= count)
+    {
+        mux.unlock();
+        return;
+    }
+    if(!rgba)
+    {
+        states[index] = 3;
+        mux.unlock();
+        return;
+    }
+    //复制到雪碧图中对应的位置
+    int lineSize = SpriteWidth() * 4;
+    unsigned char *dst = sprite.data() + (index / cols) * tileH * lineSize + (index % cols) * tileW * 4;
+    for(int y = 0; y < tileH; y++)
+        memcpy(dst + y * lineSize, rgba + y * tileW * 4, tileW * 4);
+    states[index] = 2;
+    doneCount++;
+    lastMs = XNowMs();
+    if(doneCount == count && lastMs > beginMs)
+        XLOGI("缩略图 %d 张生成完成 %.1f 张/秒", count, count * 1000.0 / (lastMs - beginMs));
+    mux.unlock();
+}
+
+void FFThumbnail::WakeAll()
+{
+    mux.lock();
+    cond.notify_all();
+    mux.unlock();
+}
+
+bool FFThumbnail::GetTile(double pos, unsigned char *rgba)
+{
+    mux.lock();
+    int index = (int)(pos * count);
+    if(index >= count) index = count - 1;
+    if(!rgba || index < 0 || states[index] != 2)
+    {
+        mux.unlock();
+        return false;
+    }
+    int lineSize = SpriteWidth() * 4;
+    const unsigned char *src = sprite.data() + (index / cols) * tileH * lineSize + (index % cols) * tileW * 4;
+    for(int y = 0; y < tileH; y++)
+        memcpy(rgba + y * tileW * 4, src + y * lineSize, tileW * 4);
+    mux.unlock();
+    return true;
+}
+
+int FFThumbnail::GetSprite(unsigned char *rgba)
+{
+    mux.lock();
+    if(rgba && !sprite.empty())
+        memcpy(rgba, sprite.data(), sprite.size());
+    int re = doneCount;
+    mux.unlock();
+    return re;
+}
+
+double FFThumbnail::ThumbsPerSec()
+{
+    mux.lock();
+    double ms = lastMs - beginMs;
+    double re = ms > 0 ? doneCount * 1000.0 / ms : 0;
+    mux.unlock();
+    return re;
+}
@@ -0,0 +1,88 @@
+#ifndef XPLAY_FFTHUMBNAIL_H
+#define XPLAY_FFTHUMBNAIL_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+class FFThumbWorker;
+
+//进度条预览缩略图，独立于播放器
+//多个工作线程各自打开文件，只解码关键帧，缩放为RGBA小图填入雪碧图
+//生成顺序按当前拖动位置的远近优先
+class FFThumbnail
+{
+public:
+    //打开文件，count张缩略图按时长均匀分布，每张tileW x tileH，雪碧图每行cols张
+    bool Open(const char *url, int count, int tileW, int tileH, int cols = 10);
+
+    //停止工作线程，清理雪碧图
+    void Close();
+
+    //当前拖动位置 0.0~1.0，优先生成附近的缩略图
+    void SetFocus(double pos);
+
+    //复制pos对应的缩略图到rgba（tileW*tileH*4字节），未生成返回false
+    bool GetTile(double pos, unsigned char *rgba);
+
+    //复制整张雪碧图到rgba（SpriteWidth*SpriteHeight*4字节），返回已生成的数量
+    int GetSprite(unsigned char *rgba);
+
+    int SpriteWidth() { return cols * tileW; }
+    int SpriteHeight() { return rows * tileH; }
+
+    //已生成数量
+    int DoneCount() { return doneCount; }
+
+    //生成速度（张/秒），从Open开始计算
+    double ThumbsPerSec();
+
+    //以下在Open前设置
+    //工作线程数
+    int workers = 2;
+    //低分辨率解码，解码器支持时（如MPEG4 MJPEG）减少解码量
+    int lowres = 1;
+
+    ~FFThumbnail();
+
+protected:
+    friend class FFThumbWorker;
+
+    //工作线程取出优先级最高的任务，没有任务时等待，退出返回-1
+    int Take(std::atomic<bool> &isExit);
+
+    //工作线程完成一张（rgba为空表示失败）
+    void Finish(int index, const unsigned char *rgba);
+
+    //唤醒等待任务的工作线程
+    void WakeAll();
+
+    //按与拖动位置的距离重建任务堆
+    void BuildHeap();
+
+    std::vector<FFThumbWorker *> threads;
+
+    int count = 0;
+    int tileW = 0;
+    int tileH = 0;
+    int cols = 1;
+    int rows = 0;
+
+    //0 未生成 1 生成中 2 已生成 3 失败
+    std::vector<unsigned char> states;
+    //任务堆，堆顶离拖动位置最近
+    std::vector<int> heap;
+    int focus = 0;
+    std::vector<unsigned char> sprite;
+
+    std::atomic<int> doneCount{0};
+    double beginMs = 0;
+    double lastMs = 0;
+
+    std::mutex mux;
+    std::condition_variable cond;
+};
+
+
+#endif //XPLAY_FFTHUMBNAIL_H
@@ -4,61 +4,82 @@
 
 void IAudioPlay::Clear()
 {
-    framesMutex.lock();
-    while(!frames.empty())
+    pendingMux.lock();
+    for(size_t i = 0; i < pending.size(); i++)
+        pending[i].Drop();
+    pending.clear();
+    pendingMux.unlock();
+    XData d;
+    while(frames.TryPop(d))
     {
-        frames.front().Drop();
-        frames.pop_front();
+        d.Drop();
     }
-    framesMutex.unlock();
+}
+
+void IAudioPlay::Stop()
+{
+    isExit = true;
+    frames.Close();
+    XThread::Stop();
+}
+
+void IAudioPlay::Wake()
+{
+    frames.Wake();
 }
 
 XData IAudioPlay::GetData()
 {
     XData d;
 
-    isRuning = true;
+    SetRuning(true);
     while(!isExit)
     {
         if(IsPause())
         {
-            XSleep(2);
+            WaitPause();
             continue;
         }
 
-        framesMutex.lock();
-        if(!frames.empty())
+        //有数据返回，无数据阻塞
+        if(frames.Pop(d))
         {
-            //有数据返回
-            d = frames.front();
-            frames.pop_front();
-            framesMutex.unlock();
             pts = d.pts;
-            return d;
+            timeBase = d.timeBase;
+            //更新音频时钟为正在播放的位置：优先用设备队列中正在播放的缓冲时间，
+            //否则按取出的数据扣除输出延迟推算
+            if(clock)
+            {
+                double ms = 0;
+                if(PlayingMs(ms))
+                    clock->SetAudio(ms, latencyMs);
+                else
+                    clock->SetAudio(d.pts, d.timeBase, OutputLatencyMs());
+            }
+            break;
         }
-        framesMutex.unlock();
-        XSleep(1);
     }
-    isRuning = false;
-    //未获取数据
+    SetRuning(false);
+    //isExit时未获取数据
     return d;
 }
 void IAudioPlay::Update(XData data)
 {
     //XLOGE("IAudioPlay::Update %d",data.pts);
-    //压入缓冲队列
+    //压入缓冲队列，缓冲满则等待音频回调消费，先送出之前暂存的数据保持顺序
+    //音频回调暂停时不再消费，不能一直阻塞（解码线程要进入暂停，跳转要清理解码器）
     if(data.size<=0|| !data.data) return;
-    while(!isExit)
+    std::lock_guard<std::mutex> lock(pendingMux);
+    pending.push_back(data);
+    size_t sent = 0;
+    while(sent < pending.size() && !isExit)
     {
-        framesMutex.lock();
-        if(frames.size() > maxFrame)
+        if(frames.Push(pending[sent], pending[sent].size, 10))
         {
-            framesMutex.unlock();
-            XSleep(1);
+            sent++;
             continue;
         }
-        frames.push_back(data);
-        framesMutex.unlock();
-        break;
+        if(IsPause()) break;
     }
+    pending.erase(pending.begin(), pending.begin() + sent);
 }
\ No newline at end of file
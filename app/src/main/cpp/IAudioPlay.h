@@ -2,14 +2,17 @@
 #define XPLAY_IAUDIOPLAY_H
 
 
-#include <list>
 #include "IObserver.h"
 #include "XParameter.h"
+#include "XQueue.h"
+#include "XClock.h"
+#include <vector>
+#include <mutex>
 
 class IAudioPlay: public IObserver
 {
 public:
-    //缓冲满后阻塞
+    //缓冲满后等待播放消费，播放暂停时不再等待，数据暂存到下次送出
     virtual void Update(XData data);
 
     //获取缓冲数据，如没有则阻塞
@@ -17,13 +20,40 @@ public:
 
     virtual bool StartPlay(XParameter out) = 0;
     virtual void Close() = 0;
+    //清空缓冲，播放回调确认暂停（SetPause返回true）或已停止后才能调用
     virtual void Clear();
-    //最大缓冲
-    int maxFrame = 100;
-    int pts = 0;
+
+    //关闭缓冲队列，唤醒阻塞的GetData和Update
+    virtual void Stop();
+    //最大缓冲时长（毫秒），按输出格式换算为字节数
+    int maxMs = 1000;
+    //缓冲最大帧数（环形缓冲槽位）
+    int maxFrame = 256;
+    //最近取出播放的数据时间（timeBase时间基）
+    long long pts = 0;
+    XRational timeBase;
+
+    //输出设备固有延迟（毫秒）
+    int latencyMs = 0;
+
+    //输出延迟（毫秒），取出的数据要在这之后才能听到
+    virtual int OutputLatencyMs() { return latencyMs; }
+
+    //输出设备正在播放的数据时间（毫秒，不含设备固有延迟），设备无法报告返回false
+    virtual bool PlayingMs(double &/*ms*/) { return false; }
+
+    //音视频同步主时钟，由播放器注入
+    XMasterClock *clock = 0;
 protected:
-    std::list <XData> frames;
-    std::mutex framesMutex;
+    //唤醒阻塞在缓冲中的音频回调
+    virtual void Wake();
+
+    //重采样线程写入，音频回调读取（单生产者单消费者，有数据时读取不加锁）
+    XQueue<XData> frames;
+
+    //暂停时未能送入缓冲的数据，按顺序等待送出（解码线程写入，Clear清理）
+    std::vector<XData> pending;
+    std::mutex pendingMux;
 };
 
 
@@ -8,73 +8,151 @@ void IDecode::Update(XData pkt)
     {
         return;
     }
-    while (!isExit)
+    //生产者 队列满则阻塞，队列关闭后丢弃
+    if(!packs.Push(pkt))
     {
-        packsMutex.lock();
+        pkt.Drop();
+    }
+}
+
+bool IDecode::TryUpdate(XData pkt)
+{
+    //非本解码器的数据，或已退出（数据丢弃），都视为已接收
+    if(pkt.isAudio != isAudio)
+    {
+        return true;
+    }
+    if(isExit)
+    {
+        pkt.Drop();
+        return true;
+    }
+    return packs.TryPush(pkt);
+}
 
-        //阻塞
-        if(packs.size() < maxList)
+XData IDecode::DecodeOne()
+{
+    packsMutex.lock();
+    XData frame = RecvFrame();
+    while(!frame.data)
+    {
+        XData pack;
+        if(!packs.TryPop(pack)) break;
+        this->SendPacket(pack);
+        pack.Drop();
+        frame = RecvFrame();
+    }
+    if(frame.data && !isAudio)
+    {
+        pts = frame.pts;
+        cache.Add(frame);
+    }
+    packsMutex.unlock();
+    return frame;
+}
+
+void IDecode::DecodePacket(XData pkt, std::vector<XData> &frames)
+{
+    std::lock_guard<std::mutex> lock(packsMutex);
+    this->SendPacket(pkt);
+    pkt.Drop();
+    //一个包可能解码出多帧，全部取出，GOP缓存中不留空缺
+    for(XData frame = RecvFrame(); frame.data; frame = RecvFrame())
+    {
+        if(!isAudio)
         {
-            //生产者
-            packs.push_back(pkt);
-            packsMutex.unlock();
-            break;
+            pts = frame.pts;
+            cache.Add(frame);
         }
-        packsMutex.unlock();
-        XSleep(1);
+        frames.push_back(frame);
     }
+}
 
+bool IDecode::Start()
+{
+    packs.SetMax(maxList);
+    packs.Open();
+    return XThread::Start();
+}
 
+void IDecode::Stop()
+{
+    isExit = true;
+    packs.Close();
+    XThread::Stop();
+}
 
+void IDecode::Wake()
+{
+    packs.Wake();
 }
+
 void IDecode::Clear()
 {
     packsMutex.lock();
-    while(!packs.empty())
+    XData pack;
+    while(packs.TryPop(pack))
     {
-        packs.front().Drop();
-        packs.pop_front();
+        pack.Drop();
     }
     pts = 0;
-    synPts = 0;
+    clearCount++;
+    cache.Break();
+    lateCount = 0;
+    onTimeCount = 0;
     packsMutex.unlock();
 }
 
+void IDecode::CheckCatchUp(const XData &frame)
+{
+    double waitMs = 0;
+    if(isAudio || !clock || !clock->WaitMs(frame.pts, frame.timeBase, waitMs)) return;
+
+    if(-waitMs > lateMs)
+    {
+        onTimeCount = 0;
+        if(++lateCount < lateFrames || catchUpLevel >= 2) return;
+        lateCount = 0;
+        catchUpCount++;
+        SetCatchUp(catchUpLevel + 1);
+        XLOGI("视频解码落后 %d ms，追赶等级提升到 %d", (int)-waitMs, catchUpLevel);
+    }
+    else
+    {
+        lateCount = 0;
+        if(++onTimeCount < recoverFrames || catchUpLevel <= 0) return;
+        onTimeCount = 0;
+        SetCatchUp(catchUpLevel - 1);
+        XLOGI("视频解码已追上，追赶等级降低到 %d", catchUpLevel);
+    }
+}
+
 void IDecode::Main()
 {
     while(!isExit)
     {
         if(IsPause())
         {
-            XSleep(2);
+            WaitPause();
             continue;
         }
 
-        packsMutex.lock();
-
-        //判断音视频同步
-        if(!isAudio && synPts > 0)
-        {
-            if(synPts < pts)
-            {
-                packsMutex.unlock();
-                XSleep(1);
-                continue;
-            }
-        }
-
-        if(packs.empty())
+        //取出packet 消费者，队列空则阻塞
+        XData pack;
+        if(!packs.Pop(pack))
         {
-            packsMutex.unlock();
-            XSleep(1);
             continue;
         }
-        //取出packet 消费者
-        XData pack = packs.front();
-        packs.pop_front();
+        //缓冲有空间，唤醒等待的解封装线程
+        if(subject) subject->OnSpace();
 
+        packsMutex.lock();
+        int clear = clearCount;
+        outFrames.clear();
         //发送数据到解码线程，一个数据包，可能解码多个结果
-        if(this->SendPacket(pack))
+        //解码器中还有未取出的帧（单步解码之后）时发送会失败，取出后重发一次
+        bool isSend = this->SendPacket(pack);
+        for(int i = 0; i < 2 && !isExit; i++)
         {
             while(!isExit)
             {
@@ -83,13 +161,30 @@ void IDecode::Main()
                 if(!frame.data) break;
                 //XLOGE("RecvFrame %d",frame.size);
                 pts = frame.pts;
-                //发送数据给观察者
-                this->Notify(frame);
-
+                CheckCatchUp(frame);
+                //追赶时跳过了帧（丢帧或跳过非参考帧），GOP不完整，不缓存
+                if(!isAudio)
+                {
+                    if(catchUpLevel >= 1)
+                        cache.Break();
+                    else
+                        cache.Add(frame);
+                }
+                outFrames.push_back(frame);
             }
-
+            if(isSend) break;
+            isSend = this->SendPacket(pack);
         }
         pack.Drop();
         packsMutex.unlock();
+
+        //发送数据给观察者（视频送入显示帧队列，音视频同步由显示线程处理）
+        //不持有packsMutex：观察者缓冲满时会阻塞，持锁会让Clear（跳转）等待解码线程而死锁
+        //Clear之后才送出的帧属于跳转前的位置，丢弃
+        for(size_t i = 0; i < outFrames.size() && !isExit && clear == clearCount; i++)
+        {
+            this->Notify(outFrames[i]);
+        }
+        outFrames.clear();
     }
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 #include "XParameter.h"
 #include "IObserver.h"
-#include <list>
+#include "XQueue.h"
+#include "XClock.h"
+#include "XGopCache.h"
 //解码接口，支持硬解码
 class IDecode:public IObserver
 {
@@ -11,31 +13,83 @@ public:
     //打开解码器
     virtual bool Open(XParameter para,bool isHard=false) = 0;
     virtual void Close() = 0;
+    //清空缓冲，解码线程确认暂停或已停止后才能调用
     virtual void Clear();
     //future模型 发送数据到线程解码
     virtual bool SendPacket(XData pkt) = 0;
 
-    //从线程中获取解码结果  再次调用会复用上次空间，线程不安全
+    //从线程中获取解码结果，返回的数据带引用计数，可以交给多个观察者
     virtual XData RecvFrame() = 0;
 
+    //解码线程确认暂停后在调用线程解码出一帧（单步），先取解码器中已有的帧，再解码读取缓冲中的包
+    //不通知观察者，缓冲中没有包返回空数据
+    virtual XData DecodeOne();
+
+    //暂停时在调用线程解码一个包（跳转定位），取出它解码出的所有帧放入frames，视频帧加入GOP缓存
+    //与解码线程用packsMutex互斥，pkt由本函数清理
+    virtual void DecodePacket(XData pkt, std::vector<XData> &frames);
+
     //由主体notify的数据 阻塞
     virtual void Update(XData pkt);
 
+    //由主体notify的数据 不阻塞，缓冲满返回false
+    //写入端属于解封装线程，其他线程只能在解封装线程确认暂停后调用
+    virtual bool TryUpdate(XData pkt);
+
+    //启动解码线程，打开缓冲队列
+    virtual bool Start();
+
+    //关闭缓冲队列，唤醒阻塞的生产者和消费者后停止线程
+    virtual void Stop();
+
     bool isAudio = false;
 
-    //最大的队列缓冲
-    int maxList = 100;
+    //解码器交接缓冲的最大包数，媒体缓冲时长和大小由解封装的XBufferPolicy控制
+    int maxList = 16;
+
+    //最近解码的帧时间（流时间基），再次打开文件要清理
+    long long pts = 0;
+
+    //追赶等级 0正常 1跳过环路滤波 2再跳过非参考帧，由解码线程按落后程度自动调整
+    virtual void SetCatchUp(int /*level*/) {}
 
-    //同步时间，再次打开文件要清理
-    int synPts = 0;
-    int pts = 0;
+    //音视频同步主时钟，视频解码器用于判断是否落后，由播放器注入
+    XMasterClock *clock = 0;
+
+    //解码出的帧落后主时钟超过lateMs（系统时间），连续lateFrames帧则提升追赶等级
+    int lateMs = 100;
+    int lateFrames = 10;
+    //连续recoverFrames帧不落后则降低追赶等级
+    int recoverFrames = 60;
+
+    //当前追赶等级，本次播放提升追赶等级的次数
+    int catchUpLevel = 0;
+    int catchUpCount = 0;
+
+    //视频解码器最近解码的GOP，后退单帧和短距离拖动直接从缓存取帧，关闭时清理
+    XGopCache cache;
 
 protected:
+    //按解码出的帧相对主时钟的落后程度调整追赶等级
+    void CheckCatchUp(const XData &frame);
+
+    //连续落后和不落后的帧数
+    int lateCount = 0;
+    int onTimeCount = 0;
+
     virtual void Main();
 
-    //读取缓冲
-    std::list<XData> packs;
+    //唤醒阻塞在读取缓冲中的解码线程
+    virtual void Wake();
+
+    //读取缓冲，解封装线程写入，解码线程读取（单生产者单消费者）
+    XQueue<XData> packs;
+    //解码过程锁，Clear时与解码互斥，通知观察者时不持有
     std::mutex packsMutex;
+    //每次Clear加一，解码线程丢弃Clear之前解码、还未送出的帧
+    std::atomic<int> clearCount{0};
+    //一个包解码出的帧，释放packsMutex后再通知观察者（解码线程使用，复用空间）
+    std::vector<XData> outFrames;
 
 
 };
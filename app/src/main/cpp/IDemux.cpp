@@ -1,5 +1,138 @@
 #include "IDemux.h"
 #include "XLog.h"
+#include "XClock.h"
+
+void IDemux::PushPacket(XData d)
+{
+    bufsMutex.lock();
+    XStreamBuffer &buf = bufs[d.isAudio ? 1 : 0];
+    buf.packs.push_back(d);
+    buf.bytes += d.size;
+    buf.isActive = true;
+    bufsMutex.unlock();
+}
+
+bool IDemux::PopPacket(bool isAudio, XData &d)
+{
+    bufsMutex.lock();
+    XStreamBuffer &buf = bufs[isAudio ? 1 : 0];
+    //队首已经送给部分观察者，不能再取出
+    if(buf.packs.empty() || buf.next != 0)
+    {
+        bufsMutex.unlock();
+        return false;
+    }
+    d = std::move(buf.packs.front());
+    buf.packs.pop_front();
+    buf.bytes -= d.size;
+    bufsMutex.unlock();
+    return true;
+}
+
+void IDemux::Clear()
+{
+    bufsMutex.lock();
+    for(XStreamBuffer &buf : bufs)
+    {
+        while(!buf.packs.empty())
+        {
+            buf.packs.front().Drop();
+            buf.packs.pop_front();
+        }
+        buf.next = 0;
+        buf.bytes = 0;
+        buf.isActive = false;
+        buf.isFull = false;
+    }
+    bufsMutex.unlock();
+}
+
+XStreamStats IDemux::GetStats(bool isAudio)
+{
+    XStreamStats stats;
+    bufsMutex.lock();
+    XStreamBuffer &buf = bufs[isAudio ? 1 : 0];
+    stats.packets = (int)buf.packs.size();
+    stats.bytes = buf.bytes;
+    stats.ms = BufferMs(buf);
+    stats.isFull = buf.isFull;
+    bufsMutex.unlock();
+    return stats;
+}
+
+bool IDemux::StartHold()
+{
+    isHold = true;
+    return XThread::Start();
+}
+
+bool IDemux::Start()
+{
+    isHold = false;
+    //等待中的读取线程开始送出预读的数据
+    Wake();
+    if(isRuning)
+    {
+        //与重新启动一样，清除之前的暂停状态
+        SetPause(false);
+        return true;
+    }
+    return XThread::Start();
+}
+
+int IDemux::BufferMs(XStreamBuffer &buf)
+{
+    if(buf.packs.size() < 2) return 0;
+    XData &back = buf.packs.back();
+    XData &front = buf.packs.front();
+    //包按解码顺序排列，有B帧时pts不单调，用dts计算；没有dts的流用pts
+    bool isDts = XPtsValid(front.dts) && XPtsValid(back.dts);
+    long long from = isDts ? front.dts : front.pts;
+    long long to = isDts ? back.dts : back.pts;
+    int ms = (int)(XPtsToMs(to, back.timeBase) - XPtsToMs(from, front.timeBase));
+    return ms > 0 ? ms : 0;
+}
+
+void IDemux::Flush(XStreamBuffer &buf)
+{
+    while(!buf.packs.empty())
+    {
+        XData &d = buf.packs.front();
+        int refuse = TryNotify(d, buf.next);
+        if(refuse >= 0)
+        {
+            buf.next = refuse;
+            return;
+        }
+        buf.bytes -= d.size;
+        buf.packs.pop_front();
+        buf.next = 0;
+    }
+}
+
+void IDemux::OnSpace()
+{
+    hasSpace = true;
+    //解封装线程等待时才加锁唤醒
+    if(!isSpaceWaiting) return;
+    std::lock_guard<std::mutex> lock(spaceMux);
+    spaceCond.notify_one();
+}
+
+void IDemux::Wake()
+{
+    std::lock_guard<std::mutex> lock(spaceMux);
+    hasSpace = true;
+    spaceCond.notify_one();
+}
+
+void IDemux::WaitSpace()
+{
+    std::unique_lock<std::mutex> lock(spaceMux);
+    isSpaceWaiting = true;
+    spaceCond.wait(lock, [this] { return hasSpace || isExit || IsPause(); });
+    isSpaceWaiting = false;
+}
 
 void IDemux::Main()
 {
@@ -7,12 +140,49 @@ void IDemux::Main()
     {
         if(IsPause())
         {
-            XSleep(2);
+            WaitPause();
             continue;
         }
+
+        //之后观察者取走数据会重新设置，等待前不会丢失
+        hasSpace = false;
+
+        //各流独立送给解码器，一个流的解码器满了不影响其他流
+        bool isActive = false;
+        bool isAllFull = true;
+        bool isOver = false;
+        bufsMutex.lock();
+        for(XStreamBuffer &buf : bufs)
+        {
+            if(!buf.isActive) continue;
+            isActive = true;
+            if(!isHold) Flush(buf);
+
+            //高水位标记为满，回落到低水位以下才恢复
+            int ms = BufferMs(buf);
+            if(ms >= policy.highMs || buf.bytes >= policy.highBytes)
+                buf.isFull = true;
+            else if(ms <= policy.lowMs && buf.bytes <= policy.lowBytes)
+                buf.isFull = false;
+
+            if(!buf.isFull)
+                isAllFull = false;
+            if(ms >= policy.maxMs || buf.bytes >= policy.maxBytes)
+                isOver = true;
+        }
+        bufsMutex.unlock();
+
+        //所有活动流都达到高水位（或某个流超过硬上限）才停止读取，
+        //等待解码器取走数据后再送出
+        if(isActive && (isAllFull || isOver))
+        {
+            WaitSpace();
+            continue;
+        }
+
         XData d = Read();
         if(d.size > 0)
-            Notify(d);
+            PushPacket(d);
         else
             XSleep(2);
         //XLOGI("IDemux Read %d",d.size);
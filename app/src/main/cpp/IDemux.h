@@ -5,6 +5,21 @@
 #include "XThread.h"
 #include "IObserver.h"
 #include "XParameter.h"
+#include "XBufferPolicy.h"
+#include <list>
+
+//单个流的解封装缓冲状态
+struct XStreamStats
+{
+    //缓冲中等待送入解码器的包数
+    int packets = 0;
+    //缓冲字节数
+    int bytes = 0;
+    //缓冲媒体时长（毫秒）
+    int ms = 0;
+    //达到高水位，尚未回落到低水位
+    bool isFull = false;
+};
 
 //解封装接口
 class IDemux: public IObserver {
@@ -23,11 +38,85 @@ public:
     //读取一帧数据，数据由调用者清理
     virtual XData Read() = 0;
 
-    //总时长（毫秒）
-    int totalMs = 0;
+    //放入对应流的缓冲，由解封装线程送给观察者(线程安全)
+    virtual void PushPacket(XData d);
+
+    //取出对应流缓冲中还没有送出的第一个包（暂停时单步使用），没有返回false(线程安全)
+    virtual bool PopPacket(bool isAudio, XData &d);
+
+    //清理所有流缓冲(线程安全)
+    virtual void Clear();
+
+    //获取音频或视频流的缓冲状态(线程安全)
+    virtual XStreamStats GetStats(bool isAudio);
+
+    //提前启动读取线程，数据只读入流缓冲，不送给观察者（解码器打开期间预读）
+    virtual bool StartHold();
+
+    //启动读取线程，已由StartHold启动时开始送出数据
+    virtual bool Start();
+
+    //解码器取走数据后调用，唤醒等待缓冲空间的读取线程
+    virtual void OnSpace();
+
+    //总时长（毫秒），直播等未知时长为0
+    long long totalMs = 0;
+
+    //最近一次Open的耗时（毫秒）：打开和读取头部、探测流信息
+    double openMs = 0;
+    double probeMs = 0;
+    //流信息来自保存的记录，跳过了探测
+    bool isInfoCached = false;
+
+    //最近一次Seek落到的关键帧距离目标的时长（毫秒），精确跳转需要解码的长度，未知为-1
+    //正好落在关键帧上为0（按时间戳比较，不受毫秒取整影响）
+    double seekGapMs = -1;
+    //seekGapMs由读取时记录的显示时间戳算出为true；由容器索引换算（近似）为false，不能用来判断正好落在关键帧上
+    bool isSeekGapExact = false;
+
+    //流缓冲策略，所有活动流都达到高水位才停止读取
+    XBufferPolicy policy;
 protected:
     virtual void Main();
 
+    //单个流的缓冲，解码器缓冲满时暂存数据，不影响其他流
+    struct XStreamBuffer
+    {
+        std::list<XData> packs;
+        //队首数据下一个要送达的观察者
+        int next = 0;
+        int bytes = 0;
+        //读到过该流的数据
+        bool isActive = false;
+        //高低水位状态
+        bool isFull = false;
+    };
+
+    //缓冲的媒体时长（毫秒）
+    static int BufferMs(XStreamBuffer &buf);
+
+    //把流缓冲中的数据送给观察者，遇到缓冲满的观察者立即返回
+    void Flush(XStreamBuffer &buf);
+
+    //缓冲都满时等待观察者取走数据（OnSpace），暂停和退出时返回
+    void WaitSpace();
+
+    //唤醒等待缓冲空间的读取线程，响应暂停、退出
+    virtual void Wake();
+
+    //上次送出后观察者取走过数据
+    std::atomic<bool> hasSpace{false};
+    //读取线程正在等待，OnSpace才需要加锁唤醒
+    std::atomic<bool> isSpaceWaiting{false};
+    std::mutex spaceMux;
+    std::condition_variable spaceCond;
+
+    //只读取不送出，由StartHold设置，Start清除
+    std::atomic<bool> isHold{false};
+
+    //0 视频 1 音频
+    XStreamBuffer bufs[2];
+    std::mutex bufsMutex;
 };
 
 
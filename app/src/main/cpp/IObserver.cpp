@@ -7,6 +7,7 @@ void IObserver::AddObs(IObserver *obs)
     if(!obs)return;
     mux.lock();
     obss.push_back(obs);
+    obs->subject = this;
     mux.unlock();
 }
 
@@ -15,10 +16,27 @@ void IObserver::Notify(XData data)
 {
 
     mux.lock();
-    for(int i =0; i < obss.size(); i++)
+    for(int i =0; i < (int)obss.size(); i++)
     {
         obss[i]->Update(data);
     }
     mux.unlock();
 
+}
+
+//非阻塞通知，遇到缓冲满的观察者立即返回其序号
+int IObserver::TryNotify(XData data, int from)
+{
+    int re = -1;
+    mux.lock();
+    for(int i = from; i < (int)obss.size(); i++)
+    {
+        if(!obss[i]->TryUpdate(data))
+        {
+            re = i;
+            break;
+        }
+    }
+    mux.unlock();
+    return re;
 }
\ No newline at end of file
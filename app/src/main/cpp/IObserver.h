@@ -11,7 +11,14 @@ class IObserver:public XThread
 {
 public:
     //观察者接收数据函数
-    virtual void Update(XData data) {}
+    virtual void Update(XData /*data*/) {}
+
+    //观察者非阻塞接收数据，缓冲满返回false，由主体稍后重试
+    virtual bool TryUpdate(XData data)
+    {
+        Update(data);
+        return true;
+    }
 
     //主体函数 添加观察者(线程安全)
     void AddObs(IObserver *obs);
@@ -19,7 +26,15 @@ public:
     //通知所有观察者(线程安全)
     void Notify(XData data);
 
+    //从第from个观察者开始非阻塞通知，返回拒绝接收的观察者序号，全部接收返回-1(线程安全)
+    int TryNotify(XData data, int from = 0);
+
+    //主体函数 观察者从缓冲取走数据后调用，等待观察者缓冲的主体可以继续通知(线程安全)
+    virtual void OnSpace() {}
+
 protected:
+    //通知本观察者的主体，由AddObs设置
+    IObserver *subject = 0;
     std::vector<IObserver *>obss;
     std::mutex mux;
 };
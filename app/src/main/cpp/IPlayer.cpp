@@ -4,6 +4,9 @@
 #include "IAudioPlay.h"
 #include "IVideoView.h"
 #include "IResample.h"
+#include "IStretch.h"
+#include "XPacketPool.h"
+#include "XFramePool.h"
 #include "XLog.h"
 
 // 获取播放器实例（单例模式）
@@ -12,60 +15,220 @@ IPlayer *IPlayer::Get(unsigned char index) {
     return &p[index];        // 返回指定索引的实例
 }
 
-// 播放器主线程函数（负责音视频同步）
-void IPlayer::Main() {
-    while (!isExit) {  // 循环直到退出标志
-        mux.lock();    // 加锁保证线程安全
+// 音视频偏差（毫秒）
+double IPlayer::AVDrift() {
+    return clock.GetDrift();
+}
 
-        // 检查音频播放器和视频解码器是否有效
-        if (!audioPlay || !vdecode) {
-            mux.unlock();
-            XSleep(2);  // 等待2ms
-            continue;
-        }
-        // 音视频同步核心逻辑
-        int apts = audioPlay->pts;  // 获取当前音频播放位置
-        vdecode->synPts = apts;     // 将音频位置同步给视频解码器
+// 本次播放丢弃的视频帧数
+int IPlayer::DropCount() {
+    return videoView ? (int)videoView->dropCount : 0;
+}
+
+// 最近一次打开各阶段的耗时
+XOpenStats IPlayer::GetOpenStats() {
+    mux.lock();
+    XOpenStats re = openStats;
+    mux.unlock();
+    return re;
+}
+
+// 对象池分配统计
+XPoolStats IPlayer::PacketPoolStats() {
+    return XPacketPool::Get()->GetStats();
+}
+
+XPoolStats IPlayer::FramePoolStats() {
+    return XFramePool::Get()->GetStats();
+}
+
+// 打开到首帧显示的耗时
+double IPlayer::FirstFrameMs() {
+    return videoView ? (double)videoView->firstFrameMs : -1;
+}
+
+// 设置播放速度
+void IPlayer::SetSpeed(double speed) {
+    if (speed < 0.5) speed = 0.5;
+    if (speed > 3.0) speed = 3.0;
+
+    mux.lock();  // 加锁
+    clock.SetSpeed(speed);                 // 主时钟按速度走动
+    if (stretch) stretch->SetSpeed(speed); // 音频变速不变调
+    mux.unlock();  // 解锁
+}
+
+// 获取播放速度
+double IPlayer::GetSpeed() {
+    return clock.GetSpeed();
+}
+
+// 单步前进一帧
+bool IPlayer::StepForward() {
+    if (!IsPause()) SetPause(true);
+    double begin = XNowMs();
+
+    mux.lock();  // 加锁
+    // 各模块确认暂停后才能操作它们的缓冲
+    if (!demux || !vdecode || !videoView || !PauseModulesWait(seekSerial)) {
+        mux.unlock();
+        return false;
+    }
+    XRational tb;
+    long long cur = videoView->GetPts(tb);
+
+    // 1. GOP缓存中有下一帧，不需要解码
+    XData frame;
+    bool isCache = vdecode->cache.Next(cur, frame);
+
+    // 2. 从现有缓冲中取出下一帧，跳过不晚于当前位置的帧
+    while (!isCache && !isExit) {
+        frame = NextPipeFrame();
+        if (!frame.data || frame.pts > cur) break;
+    }
+
+    bool re = frame.data != 0;
+    if (re) ShowStep(frame);
+    mux.unlock();  // 解锁
+
+    stepMs = XNowMs() - begin;
+    XLOGI("单步前进 %s 耗时 %.1f ms 缓存 %d", re ? "成功" : "失败", (double)stepMs, isCache);
+    return re;
+}
+
+// 单步后退一帧
+bool IPlayer::StepBackward() {
+    if (!IsPause()) SetPause(true);
+    double begin = XNowMs();
+
+    mux.lock();  // 加锁
+    if (!demux || !vdecode || !videoView || demux->totalMs <= 0 || !PauseModulesWait(seekSerial)) {
         mux.unlock();
-        XSleep(2);  // 每2ms同步一次
+        return false;
+    }
+    XRational tb;
+    long long cur = videoView->GetPts(tb);
+
+    // 1. GOP缓存中有上一帧，不需要解码
+    XData frame;
+    bool isCache = vdecode->cache.Prev(cur, frame);
+    if (!isCache) {
+        // 2. 跳到当前帧之前的关键帧，解码到当前帧（中间帧只放入GOP缓存不显示），再从缓存取上一帧
+        double pos = XPtsToPos(cur, tb, demux->totalMs) - 0.5 / demux->totalMs;
+        if (pos >= 0 && SeekLocked(pos, XSEEK_ACCURATE, seekSerial, false))
+            vdecode->cache.Prev(cur, frame);
+    }
+
+    bool re = frame.data != 0;
+    if (re) ShowStep(frame);
+    mux.unlock();  // 解锁
+
+    stepMs = XNowMs() - begin;
+    XLOGI("单步后退 %s 耗时 %.1f ms 缓存 %d", re ? "成功" : "失败", (double)stepMs, isCache);
+    return re;
+}
+
+// 最近一次单步的耗时（毫秒）
+double IPlayer::StepMs() {
+    return stepMs;
+}
+
+// 单步显示一帧，恢复播放时跳转到该帧重新同步音视频
+void IPlayer::ShowStep(XData frame) {
+    videoView->ShowFrame(frame);
+    if (demux->totalMs <= 0) return;  // 没有时长（直播）无法跳转
+    hasDeferSeek = true;
+    deferSeekPos = XPtsToPos(frame.pts, frame.timeBase, demux->totalMs);
+    if (deferSeekPos > 1) deferSeekPos = 1;
+}
+
+// 依次从显示队列、解码器、解封装缓冲、文件取出下一帧视频
+XData IPlayer::NextPipeFrame() {
+    XData frame;
+    if (videoView->PopFrame(frame)) return frame;
+    while (!isExit) {
+        frame = vdecode->DecodeOne();
+        if (frame.data) break;
+
+        // 解码缓冲已空，从解封装缓冲或文件补充视频包
+        XData pkt;
+        if (!demux->PopPacket(false, pkt)) {
+            pkt = demux->Read();
+            if (pkt.size <= 0) break;  // 文件结束
+            if (pkt.isAudio) {
+                demux->PushPacket(pkt);  // 音频包留给恢复播放
+                continue;
+            }
+        }
+        if (!vdecode->TryUpdate(pkt)) pkt.Drop();
     }
+    return frame;
 }
 
 // 关闭播放器并释放所有资源
 void IPlayer::Close() {
+    // 0. 取消跳转请求，停止播放器线程（正在执行的跳转会退出）
+    seekMux.lock();
+    hasSeek = false;
+    seekCb = nullptr;
+    seekSerial++;
+    isSeeking = false;
+    seekMux.unlock();
+    XThread::Stop();
+
     mux.lock();  // 加锁
 
-    // 1. 停止所有线程
-    XThread::Stop();  // 停止主线程
-    if (demux) demux->Stop();
-    if (vdecode) vdecode->Stop();
-    if (adecode) adecode->Stop();
+    if (videoView && vdecode && videoView->dropCount > 0) {
+        XLOGI("本次播放丢弃 %d 帧，解码追赶 %d 次", (int)videoView->dropCount, vdecode->catchUpCount);
+    }
+    // 对象池累计统计，稳定播放后分配次数不再增长
+    XPoolStats ps = PacketPoolStats();
+    XPoolStats fs = FramePoolStats();
+    XLOGI("AVPacket池 分配 %lld 复用 %lld 释放 %lld 空闲 %d，AVFrame池 分配 %lld 复用 %lld 释放 %lld 空闲 %d",
+          ps.allocs, ps.reuses, ps.frees, ps.idle, fs.allocs, fs.reuses, fs.frees, fs.idle);
+
+    // 1. 停止所有线程，从下游到上游，先关闭的缓冲队列会唤醒阻塞在写入的上游线程
     if (audioPlay) audioPlay->Stop();
+    if (videoView) videoView->Stop();
+    if (adecode) adecode->Stop();
+    if (vdecode) vdecode->Stop();
+    if (demux) demux->Stop();
 
     // 2. 清空所有缓冲队列
+    if (demux) demux->Clear();
+    if (videoView) videoView->Clear();
     if (vdecode) vdecode->Clear();
     if (adecode) adecode->Clear();
+    if (stretch) stretch->Clear();
     if (audioPlay) audioPlay->Clear();
+    clock.Reset();
 
     // 3. 关闭所有模块
     if (audioPlay) audioPlay->Close();
     if (videoView) videoView->Close();
     if (vdecode) vdecode->Close();
     if (adecode) adecode->Close();
+    if (stretch) stretch->Close();
     if (demux) demux->Close();
+    hasDeferSeek = false;
 
     mux.unlock();  // 解锁
 }
 
 // 获取当前播放进度（0.0~1.0）
 double IPlayer::PlayPos() {
+    // 跳转未完成时直接返回目标位置，不等待跳转
+    if (isSeeking) return seekTarget;
+
     double pos = 0.0;
     mux.lock();  // 加锁
 
     if (demux) {
-        int total = demux->totalMs;  // 媒体总时长
-        if (total > 0 && vdecode) {
-            pos = (double)vdecode->pts / (double)total;  // 计算进度百分比
+        long long total = demux->totalMs;  // 媒体总时长
+        if (total > 0 && videoView) {
+            XRational tb;
+            long long pts = videoView->GetPts(tb);
+            pos = XPtsToPos(pts, tb, total);  // 计算进度百分比(已显示的帧)
         }
     }
 
@@ -74,70 +237,194 @@ double IPlayer::PlayPos() {
 }
 
 // 设置暂停状态
-void IPlayer::SetPause(bool isP) {
+bool IPlayer::SetPause(bool isP) {
+    isPause = isP;  // 记录暂停状态(播放器线程只处理跳转，不需要等待确认)
+
     mux.lock();  // 加锁
+    // 暂停中从缓存显示的位置，恢复时先跳转，跳转完成后由播放器线程恢复播放
+    if (!isP && hasDeferSeek) {
+        hasDeferSeek = false;
+        double pos = deferSeekPos;
+        mux.unlock();
+        return SeekAsync(pos, XSEEK_ACCURATE);
+    }
+    bool re = PauseModules(isP);
+    mux.unlock();  // 解锁
+    return re;
+}
 
-    // 设置所有模块的暂停状态
-    XThread::SetPause(isP);  // 主线程
-    if (demux) demux->SetPause(isP);
-    if (vdecode) vdecode->SetPause(isP);
-    if (adecode) adecode->SetPause(isP);
-    if (audioPlay) audioPlay->SetPause(isP);
+// 设置所有模块的暂停状态，返回是否全部确认
+bool IPlayer::PauseModules(bool isP) {
+    bool re = true;
+    if (demux) re = demux->SetPause(isP) && re;
+    if (vdecode) re = vdecode->SetPause(isP) && re;
+    if (adecode) re = adecode->SetPause(isP) && re;
+    if (audioPlay) re = audioPlay->SetPause(isP) && re;
+    // 显示线程最后暂停，视频解码器确认暂停前可能还在等待显示线程消费
+    if (videoView) re = videoView->SetPause(isP) && re;
+
+    // 暂停时主时钟停止走动
+    clock.SetPause(isP);
+    return re;
+}
 
-    mux.unlock();  // 解锁
+// 暂停并等待所有模块确认，未确认时临时解锁，让其他调用（如暂停、进度）不被阻塞
+bool IPlayer::PauseModulesWait(int serial) {
+    while (!PauseModules(true)) {
+        if (isExit || serial != seekSerial) return false;
+        mux.unlock();
+        std::this_thread::yield();
+        mux.lock();
+    }
+    return true;
 }
 
 // 跳转到指定位置
 bool IPlayer::Seek(double pos) {
+    return SeekAsync(pos, seekMode);
+}
+
+// 异步跳转，只记录请求，由播放器线程执行
+bool IPlayer::SeekAsync(double pos, XSeekMode mode, XSeekCallback cb) {
+    if (pos < 0 || pos > 1) {
+        XLOGE("Seek value must 0.0~1.0");
+        return false;
+    }
+
+    seekMux.lock();
+    // 覆盖未执行的请求，序号改变使正在执行的跳转取消
+    seekPos = pos;
+    seekReqMode = mode;
+    seekCb = cb;
+    hasSeek = true;
+    seekSerial++;
+    seekTarget = pos;
+    isSeeking = true;
+    seekCond.notify_one();
+    seekMux.unlock();
+    return true;
+}
+
+// 唤醒等待跳转请求的播放器线程
+void IPlayer::Wake() {
+    seekMux.lock();
+    seekCond.notify_all();
+    seekMux.unlock();
+}
+
+// 播放器线程：等待并执行跳转请求
+void IPlayer::Main() {
+    while (!isExit) {
+        std::unique_lock<std::mutex> lock(seekMux);
+        seekCond.wait(lock, [this] { return hasSeek || isExit; });
+        if (isExit) break;
+
+        // 只取最新的请求
+        double pos = seekPos;
+        XSeekMode mode = seekReqMode;
+        XSeekCallback cb = seekCb;
+        int serial = seekSerial;
+        hasSeek = false;
+        seekCb = nullptr;
+        lock.unlock();
+
+        bool re = DoSeek(pos, mode, serial);
+
+        // 执行中有新的请求，不恢复播放，直接执行新的请求
+        if (serial != seekSerial) continue;
+
+        // 恢复播放（用户暂停时保持暂停）
+        mux.lock();
+        if (!isPause) PauseModules(false);
+        mux.unlock();
+        isSeeking = false;
+
+        if (cb) cb(pos, re);
+    }
+}
+
+// 在播放器线程中执行跳转
+bool IPlayer::DoSeek(double pos, XSeekMode mode, int serial) {
     if (!demux) return false;  // 检查解封装器
 
-    SetPause(true);  // 暂停播放
-    mux.lock();      // 加锁
+    mux.lock();         // 加锁
+    // 暂停播放，所有模块确认后才能清空它们的缓冲
+    if (!PauseModulesWait(serial)) {
+        mux.unlock();
+        return false;
+    }
+    hasDeferSeek = false;
+    double seekMs = pos * demux->totalMs;  // 目标位置(毫秒)
+
+    // 0. 暂停中精确跳转且目标帧在GOP缓存中：直接显示缓存的帧，不解封装也不解码
+    XData cached;
+    if (isPause && mode == XSEEK_ACCURATE && vdecode && videoView && vdecode->cache.Find(seekMs, cached)) {
+        videoView->ShowFrame(cached);
+        hasDeferSeek = true;
+        deferSeekPos = pos;
+        mux.unlock();
+        return true;
+    }
+
+    bool re = SeekLocked(pos, mode, serial, isPause);
+    mux.unlock();      // 解锁
+    return re;
+}
 
-    // 1. 清空所有缓冲
-    if (vdecode) vdecode->Clear();
-    if (adecode) adecode->Clear();
+// 清空缓冲并跳转，调用者加锁且模块已暂停
+bool IPlayer::SeekLocked(double pos, XSeekMode mode, int serial, bool isShow) {
+    double seekMs = pos * demux->totalMs;  // 目标位置(毫秒)
+
+    // 1. 清空所有缓冲，从下游到上游，阻塞在写入下游的解码线程先被放开
     if (audioPlay) audioPlay->Clear();
+    if (stretch) stretch->Clear();
+    if (videoView) videoView->Clear();
+    if (adecode) adecode->Clear();
+    if (vdecode) vdecode->Clear();
+    demux->Clear();
+    clock.Reset();
 
     // 2. 执行跳转
-    bool re = demux->Seek(pos);  // 解封装器跳转
-    if (!re || !vdecode) {
-        mux.unlock();
-        SetPause(false);
+    bool re = demux->Seek(pos);  // 解封装器跳转(目标之前的关键帧)
+    if (re && demux->seekGapMs >= 0) {
+        XLOGI("跳转到关键帧，距离目标%s %.1f ms", demux->isSeekGapExact ? "" : "约", demux->seekGapMs);
+    }
+    // 快速跳转或正好落在关键帧上，不需要解码到目标；暂停中仍要解码出关键帧显示
+    // 距离是近似值时不能确定落在关键帧上，按解码出的帧判断
+    bool isKeyOnly = mode == XSEEK_FAST || (demux->seekGapMs == 0 && demux->isSeekGapExact);
+    if (!re || !vdecode || (isKeyOnly && !isShow)) {
         return re;
     }
 
-    // 3. 定位到精确帧
-    int seekPts = pos * demux->totalMs;  // 目标位置(毫秒)
-    while (!isExit) {
+    // 3. 定位到精确帧（只显示关键帧时为解码出的第一帧），有新的跳转请求时放弃
+    std::vector<XData> frames;
+    while (!isExit && serial == seekSerial) {
         XData pkt = demux->Read();  // 读取数据包
         if (pkt.size <= 0) break;
 
         if (pkt.isAudio) {  // 音频包处理
-            if (pkt.pts < seekPts) {
-                pkt.Drop();  // 丢弃早于目标位置的音频
+            if (!isKeyOnly && XPtsToMs(pkt.pts, pkt.timeBase) < seekMs) {
+                pkt.Drop();  // 丢弃早于目标位置的音频（快速跳转从关键帧播放，保留）
                 continue;
             }
-            demux->Notify(pkt);  // 将有效音频包加入队列
+            demux->PushPacket(pkt);  // 将有效音频包放入音频流缓冲
             continue;
         }
 
-        // 视频包处理
-        vdecode->SendPacket(pkt);  // 发送给视频解码器
-        pkt.Drop();
-
-        // 解码视频帧
-        XData data = vdecode->RecvFrame();
-        if (data.size <= 0) continue;
+        // 视频包解码出的所有帧（跳过的帧放入GOP缓存，之后在这一段拖动不再解码）
+        frames.clear();
+        vdecode->DecodePacket(pkt, frames);
 
-        // 找到目标帧后停止
-        if (data.pts >= seekPts) {
-            break;
+        // 找到目标帧后停止，暂停中直接显示
+        bool isFound = false;
+        for (size_t i = 0; i < frames.size() && !isFound; i++) {
+            if (isKeyOnly || XPtsToMs(frames[i].pts, frames[i].timeBase) >= seekMs) {
+                if (isShow && videoView) videoView->ShowFrame(frames[i]);
+                isFound = true;
+            }
         }
+        if (isFound) break;
     }
-
-    mux.unlock();      // 解锁
-    SetPause(false);   // 恢复播放
     return re;
 }
 
@@ -145,6 +432,15 @@ bool IPlayer::Seek(double pos) {
 bool IPlayer::Open(const char *path) {
     Close();  // 先关闭可能存在的旧实例
     mux.lock();  // 加锁
+    if (videoView) videoView->dropCount = 0;  // 丢帧统计按每次播放计算
+    if (videoView) {
+        // 首帧耗时从打开开始计算
+        videoView->openBeginMs = XNowMs();
+        videoView->firstFrameMs = -1;
+    }
+
+    XOpenStats stats;
+    double begin = XNowMs();
 
     // 1. 打开解封装器
     if (!demux || !demux->Open(path)) {
@@ -152,24 +448,50 @@ bool IPlayer::Open(const char *path) {
         XLOGE("解封装器打开失败: %s", path);
         return false;
     }
+    stats.demuxMs = demux->openMs;
+    stats.probeMs = demux->probeMs;
+
+    // 2. 流参数只获取一次，容器就绪后立即开始预读（解码器打开期间数据只进入流缓冲）
+    //    参数是解封装器复制的副本，预读修改流的codecpar不影响解码器打开
+    XParameter vpara = demux->GetVPara();
+    XParameter apara = demux->GetAPara();
+    demux->StartHold();
+
+    // 3. 视频解码器（硬解码初始化较慢）在另一个线程打开，与音频并行
+    std::thread vth([this, vpara, &stats] {
+        double vbegin = XNowMs();
+        if (!vdecode || !vdecode->Open(vpara, isHardDecode)) {
+            XLOGE("视频解码器打开失败");
+            // 注：解码失败不直接返回，尝试继续
+        }
+        stats.vdecodeMs = XNowMs() - vbegin;
+    });
 
-    // 2. 打开视频解码器
-    if (!vdecode || !vdecode->Open(demux->GetVPara(), isHardDecode)) {
-        XLOGE("视频解码器打开失败: %s", path);
-        // 注：解码失败不直接返回，尝试继续
-    }
-
-    // 3. 打开音频解码器
-    if (!adecode || !adecode->Open(demux->GetAPara())) {
+    // 4. 打开音频解码器
+    double abegin = XNowMs();
+    if (!adecode || !adecode->Open(apara)) {
         XLOGE("音频解码器打开失败: %s", path);
         // 注：解码失败不直接返回，尝试继续
     }
+    stats.adecodeMs = XNowMs() - abegin;
 
-    // 4. 配置音频重采样
-    outPara = demux->GetAPara();  // 获取音频参数
-    if (!resample || !resample->Open(demux->GetAPara(), outPara)) {
+    // 5. 配置音频重采样和变速（处理重采样后的PCM）
+    abegin = XNowMs();
+    outPara = apara;  // 输出参数与输入相同
+    if (!resample || !resample->Open(apara, outPara)) {
         XLOGE("音频重采样打开失败: %s", path);
     }
+    if (!stretch || !stretch->Open(outPara)) {
+        XLOGE("音频变速打开失败: %s", path);
+    }
+    stats.resampleMs = XNowMs() - abegin;
+
+    vth.join();
+    stats.totalMs = XNowMs() - begin;
+    openStats = stats;
+    XLOGI("打开耗时 %.1f ms：解封装 %.1f 探测 %.1f%s 视频解码 %.1f 音频解码 %.1f 重采样 %.1f",
+          stats.totalMs, stats.demuxMs, stats.probeMs, demux->isInfoCached ? "(缓存)" : "",
+          stats.vdecodeMs, stats.adecodeMs, stats.resampleMs);
 
     mux.unlock();  // 解锁
     return true;
@@ -179,23 +501,24 @@ bool IPlayer::Open(const char *path) {
 bool IPlayer::Start() {
     mux.lock();  // 加锁
 
-    // 1. 启动视频解码器
+    // 1. 启动视频显示线程和视频解码器
+    if (videoView) videoView->Start();
     if (vdecode) vdecode->Start();
 
-    // 2. 启动解封装器
+    // 2. 启动音频解码器（先于解封装器打开缓冲队列）
+    if (adecode) adecode->Start();
+
+    // 3. 启动解封装器（Open中已开始预读，此时开始送出数据）
     if (!demux || !demux->Start()) {
         mux.unlock();
         XLOGE("解封装器启动失败!");
         return false;
     }
 
-    // 3. 启动音频解码器
-    if (adecode) adecode->Start();
-
     // 4. 启动音频播放器
     if (audioPlay) audioPlay->StartPlay(outPara);
 
-    // 5. 启动主线程（音视频同步）
+    // 5. 启动播放器线程，处理跳转请求
     XThread::Start();
 
     mux.unlock();  // 解锁
@@ -2,8 +2,12 @@
 #define XPLAY_IPLAYER_H
 
 #include <mutex>              // 互斥锁头文件
+#include <condition_variable> // 条件变量头文件
+#include <functional>         // 回调函数
 #include "XThread.h"          // 线程基类
 #include "XParameter.h"        // 音频参数定义
+#include "XClock.h"            // 音视频同步时钟
+#include "XObjectPool.h"       // 对象池统计
 
 // 前置声明各模块接口
 class IDemux;    // 解复用器接口
@@ -11,8 +15,30 @@ class IAudioPlay; // 音频播放接口
 class IVideoView; // 视频渲染接口
 class IResample;  // 音频重采样接口
 class IDecode;    // 解码器接口
+class IStretch;   // 变速处理接口
+
+// 跳转模式
+enum XSeekMode {
+    XSEEK_ACCURATE = 0,  // 精确跳转：从关键帧解码到目标位置
+    XSEEK_FAST = 1       // 快速跳转：只跳到目标之前最近的关键帧
+};
+
+// 跳转完成回调（在播放器线程中调用）
+// pos: 目标位置 re: 是否成功
+typedef std::function<void(double pos, bool re)> XSeekCallback;
+
+// 打开各阶段耗时（毫秒）
+struct XOpenStats {
+    double demuxMs = 0;     // 解封装打开（含读取头部）
+    double probeMs = 0;     // 探测流信息，使用保存的记录时接近0
+    double vdecodeMs = 0;   // 视频解码器打开（与音频并行）
+    double adecodeMs = 0;   // 音频解码器打开
+    double resampleMs = 0;  // 重采样和变速打开
+    double totalMs = 0;     // 整个Open
+};
 
 // 播放器核心控制类
+// 播放器线程只处理跳转请求，不阻塞调用者
 class IPlayer : public XThread {
 public:
     // 获取播放器实例（单例模式）
@@ -37,17 +63,67 @@ public:
     // 返回值: 0.0 ~ 1.0之间的进度值
     virtual double PlayPos();
 
-    // 跳转到指定位置
+    // 跳转到指定位置（异步，按seekMode跳转，立即返回）
     // pos: 0.0 ~ 1.0之间的位置值
     virtual bool Seek(double pos);
 
+    // 异步跳转，请求交给播放器线程后立即返回
+    // 连续请求只执行最新的一个，正在执行的跳转会被取消，被取代的请求不回调
+    // pos: 0.0 ~ 1.0之间的位置值 mode: 跳转模式 cb: 完成回调
+    virtual bool SeekAsync(double pos, XSeekMode mode = XSEEK_ACCURATE, XSeekCallback cb = nullptr);
+
+    // 播放器线程入口，执行跳转请求
+    virtual void Main();
+
+    // 单步前进一帧（暂停状态，未暂停时先暂停），在调用线程执行
+    // 优先从GOP缓存取下一帧，否则从现有的显示队列、解码缓冲中解码一帧
+    virtual bool StepForward();
+
+    // 单步后退一帧（暂停状态，未暂停时先暂停），在调用线程执行
+    // 优先从GOP缓存取上一帧，否则跳到之前的关键帧向前解码（中间帧不显示）
+    virtual bool StepBackward();
+
+    // 最近一次单步的耗时（毫秒）
+    virtual double StepMs();
+
     // 设置暂停状态
     // isP: true暂停, false继续
-    virtual void SetPause(bool isP);
+    // 返回各模块是否都已确认（暂停时有模块阻塞在读取中未确认返回false）
+    virtual bool SetPause(bool isP);
+
+    // 音视频偏差（毫秒，正数视频超前）
+    virtual double AVDrift();
+
+    // 本次播放因落后丢弃的视频帧数
+    virtual int DropCount();
+
+    // 打开到首帧显示的耗时（毫秒），未显示返回-1
+    virtual double FirstFrameMs();
+
+    // 最近一次Open各阶段的耗时
+    virtual XOpenStats GetOpenStats();
+
+    // AVPacket和AVFrame对象池的分配统计（进程内所有播放器共用）
+    // 稳定播放时allocs不再增长，只增加reuses
+    virtual XPoolStats PacketPoolStats();
+    virtual XPoolStats FramePoolStats();
+
+    // 设置播放速度
+    // speed: 0.5 ~ 3.0，音频变速不变调，视频按主时钟丢帧或延长显示
+    virtual void SetSpeed(double speed);
+
+    // 获取播放速度
+    virtual double GetSpeed();
 
     // 是否使用视频硬解码
     bool isHardDecode = true;
 
+    // Seek使用的跳转模式
+    XSeekMode seekMode = XSEEK_ACCURATE;
+
+    // 音视频同步主时钟（音频/视频/外部时钟模式）
+    XMasterClock clock;
+
     // 音频输出参数配置
     XParameter outPara;
 
@@ -59,17 +135,60 @@ public:
     IDecode *vdecode = 0;   // 视频解码器模块
     IDecode *adecode = 0;   // 音频解码器模块
     IResample *resample = 0; // 音频重采样模块
+    IStretch *stretch = 0;   // 音频变速模块
     IVideoView *videoView = 0; // 视频渲染模块
     IAudioPlay *audioPlay = 0; // 音频播放模块
     // ===========================
 
 protected:
-    // 主线程函数（用于音视频同步）
-    void Main();
+    // 在播放器线程中执行跳转，serial改变（有新的请求）时取消
+    bool DoSeek(double pos, XSeekMode mode, int serial);
+
+    // 清空缓冲并跳转，isShow显示目标帧（调用者加锁，模块已暂停）
+    bool SeekLocked(double pos, XSeekMode mode, int serial, bool isShow);
+
+    // 设置各模块暂停状态（调用者加锁），所有模块线程确认后返回true
+    // 未确认的模块可能还在读写缓冲，跳转和单步必须等到确认后才能操作缓冲
+    bool PauseModules(bool isP);
+
+    // 暂停各模块并等待全部确认（调用者加锁，等待时临时解锁）
+    // serial改变（有新的跳转请求）或退出时放弃，返回false
+    bool PauseModulesWait(int serial);
+
+    // 从显示队列、解码器、解封装缓冲、文件依次取出下一帧视频（调用者加锁，模块已暂停）
+    XData NextPipeFrame();
+
+    // 单步显示一帧，恢复播放时跳转到该帧（调用者加锁）
+    void ShowStep(XData frame);
+
+    // 最近一次单步的耗时（毫秒）
+    std::atomic<double> stepMs{0};
+
+    // 最近一次Open各阶段的耗时（mux保护）
+    XOpenStats openStats;
+
+    // 唤醒等待跳转请求的播放器线程
+    virtual void Wake();
 
     // 互斥锁（保证线程安全）
     std::mutex mux;
 
+    // ===== 跳转请求（seekMux保护） =====
+    std::mutex seekMux;
+    std::condition_variable seekCond;
+    bool hasSeek = false;           // 有未执行的请求
+    double seekPos = 0;             // 最新请求的目标位置
+    XSeekMode seekReqMode = XSEEK_ACCURATE;
+    XSeekCallback seekCb;           // 最新请求的回调
+    std::atomic<int> seekSerial{0}; // 请求序号，每个新请求加一
+    std::atomic<bool> isSeeking{false};  // 跳转未完成，进度返回目标位置
+    std::atomic<double> seekTarget{0};
+    // ===========================
+
+    // 暂停时从GOP缓存显示了目标帧，还没有真正跳转，恢复播放前跳转到该位置（mux保护）
+    bool hasDeferSeek = false;
+    double deferSeekPos = 0;
+
     // 保护构造函数（只能通过Get方法创建实例）
     IPlayer(){};
 };
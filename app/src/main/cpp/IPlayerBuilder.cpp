@@ -1,6 +1,7 @@
 #include "IPlayerBuilder.h"
 #include "IVideoView.h"
 #include "IResample.h"
+#include "IStretch.h"
 #include "IDecode.h"
 #include "IAudioPlay.h"
 #include "IDemux.h"
@@ -30,15 +31,25 @@ IPlayer *IPlayerBuilder::BuilderPlayer(unsigned char index)
     IResample *resample = CreateResample();
     adecode->AddObs(resample);
 
-    //音频播放观察重采样
+    //变速观察重采样
+    IStretch *stretch = CreateStretch();
+    resample->AddObs(stretch);
+
+    //音频播放观察变速
     IAudioPlay *audioPlay = CreateAudioPlay();
-    resample->AddObs(audioPlay);
+    stretch->AddObs(audioPlay);
+
+    //显示、视频解码和音频播放使用播放器的主时钟同步
+    view->clock = &play->clock;
+    vdecode->clock = &play->clock;
+    audioPlay->clock = &play->clock;
 
     play->demux = de;
     play->adecode = adecode;
     play->vdecode = vdecode;
     play->videoView = view;
     play->resample = resample;
+    play->stretch = stretch;
     play->audioPlay = audioPlay;
     return play;
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ protected:
     virtual IDemux *CreateDemux() = 0;
     virtual IDecode *CreateDecode() = 0;
     virtual IResample *CreateResample() = 0;
+    virtual IStretch *CreateStretch() = 0;
     virtual IVideoView *CreateVideoView()  = 0;
     virtual IAudioPlay *CreateAudioPlay() = 0;
     virtual IPlayer *CreatePlayer(unsigned char index=0) = 0;
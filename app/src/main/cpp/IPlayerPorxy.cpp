@@ -33,6 +33,72 @@ double IPlayerPorxy::PlayPos()
     mux.unlock();
     return pos;
 }
+double IPlayerPorxy::AVDrift()
+{
+    double re = 0.0;
+    mux.lock();
+    if(player)
+    {
+        re = player->AVDrift();
+    }
+    mux.unlock();
+    return re;
+}
+int IPlayerPorxy::DropCount()
+{
+    int re = 0;
+    mux.lock();
+    if(player)
+    {
+        re = player->DropCount();
+    }
+    mux.unlock();
+    return re;
+}
+double IPlayerPorxy::FirstFrameMs()
+{
+    double re = -1;
+    mux.lock();
+    if(player)
+    {
+        re = player->FirstFrameMs();
+    }
+    mux.unlock();
+    return re;
+}
+XOpenStats IPlayerPorxy::GetOpenStats()
+{
+    XOpenStats re;
+    mux.lock();
+    if(player)
+    {
+        re = player->GetOpenStats();
+    }
+    mux.unlock();
+    return re;
+}
+XPoolStats IPlayerPorxy::PacketPoolStats()
+{
+    XPoolStats re;
+    mux.lock();
+    if(player)
+    {
+        re = player->PacketPoolStats();
+    }
+    mux.unlock();
+    return re;
+}
+XPoolStats IPlayerPorxy::FramePoolStats()
+{
+    XPoolStats re;
+    mux.lock();
+    if(player)
+    {
+        re = player->FramePoolStats();
+    }
+    mux.unlock();
+    return re;
+}
 bool IPlayerPorxy::IsPause()
 {
     bool re = false;
@@ -43,12 +109,14 @@ bool IPlayerPorxy::IsPause()
     return re;
 }
 
-void IPlayerPorxy::SetPause(bool isP)
+bool IPlayerPorxy::SetPause(bool isP)
 {
+    bool re = false;
     mux.lock();
     if(player)
-        player->SetPause(isP);
+        re = player->SetPause(isP);
     mux.unlock();
+    return re;
 }
 bool IPlayerPorxy::Seek(double pos)
 {
@@ -62,6 +130,18 @@ bool IPlayerPorxy::Seek(double pos)
     return re;
 }
 
+bool IPlayerPorxy::SeekAsync(double pos, XSeekMode mode, XSeekCallback cb)
+{
+    bool re = false;
+    mux.lock();
+    if(player)
+    {
+        re = player->SeekAsync(pos, mode, cb);
+    }
+    mux.unlock();
+    return re;
+}
+
 bool IPlayerPorxy::Open(const char *path)
 {
     bool re = false;
@@ -90,4 +170,47 @@ void IPlayerPorxy::InitView(void *win)
     if(player)
         player->InitView(win);
     mux.unlock();
-}
\ No newline at end of file
+}
+void IPlayerPorxy::SetSpeed(double speed)
+{
+    mux.lock();
+    if(player)
+        player->SetSpeed(speed);
+    mux.unlock();
+}
+double IPlayerPorxy::GetSpeed()
+{
+    double re = 1.0;
+    mux.lock();
+    if(player)
+        re = player->GetSpeed();
+    mux.unlock();
+    return re;
+}
+bool IPlayerPorxy::StepForward()
+{
+    bool re = false;
+    mux.lock();
+    if(player)
+        re = player->StepForward();
+    mux.unlock();
+    return re;
+}
+bool IPlayerPorxy::StepBackward()
+{
+    bool re = false;
+    mux.lock();
+    if(player)
+        re = player->StepBackward();
+    mux.unlock();
+    return re;
+}
+double IPlayerPorxy::StepMs()
+{
+    double re = 0;
+    mux.lock();
+    if(player)
+        re = player->StepMs();
+    mux.unlock();
+    return re;
+}
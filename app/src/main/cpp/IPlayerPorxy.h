@@ -16,13 +16,32 @@ public:
 
     virtual bool Open(const char *path);
     virtual bool Seek(double pos);
+    virtual bool SeekAsync(double pos, XSeekMode mode = XSEEK_ACCURATE, XSeekCallback cb = nullptr);
     virtual void Close();
     virtual bool Start();
     virtual void InitView(void *win);
-    virtual void SetPause(bool isP);
+    virtual bool SetPause(bool isP);
     virtual bool IsPause();
     //获取当前的播放进度 0.0 ~ 1.0
     virtual double PlayPos();
+    //音视频偏差（毫秒）
+    virtual double AVDrift();
+    //本次播放丢弃的视频帧数
+    virtual int DropCount();
+    //打开到首帧显示的耗时（毫秒）
+    virtual double FirstFrameMs();
+    //最近一次打开各阶段的耗时
+    virtual XOpenStats GetOpenStats();
+    //AVPacket和AVFrame对象池的分配统计
+    virtual XPoolStats PacketPoolStats();
+    virtual XPoolStats FramePoolStats();
+    //单步前进、后退一帧，最近一次单步的耗时（毫秒）
+    virtual bool StepForward();
+    virtual bool StepBackward();
+    virtual double StepMs();
+    //播放速度 0.5 ~ 3.0
+    virtual void SetSpeed(double speed);
+    virtual double GetSpeed();
 protected:
     IPlayerPorxy(){}
     IPlayer *player = 0;
@@ -0,0 +1,10 @@
+#include "IStretch.h"
+
+void IStretch::Update(XData data)
+{
+    XData d = this->Stretch(data);
+    if(d.size > 0)
+    {
+        this->Notify(d);
+    }
+}
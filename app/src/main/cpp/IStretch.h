@@ -0,0 +1,28 @@
+#ifndef XPLAY_ISTRETCH_H
+#define XPLAY_ISTRETCH_H
+
+#include "XParameter.h"
+#include "IObserver.h"
+
+//变速不变调，位于重采样和音频播放之间，观察重采样输出的S16交错PCM
+class IStretch: public IObserver
+{
+public:
+    //out为重采样的输出参数
+    virtual bool Open(XParameter out) = 0;
+    virtual void Close() = 0;
+
+    //清理缓存的PCM，seek时调用
+    virtual void Clear() = 0;
+
+    //播放速度 0.5 ~ 3.0，1.0时数据直接透传
+    virtual void SetSpeed(double speed) = 0;
+
+    //输入一段PCM，返回变速后的PCM，缓存不足一段时返回空数据
+    virtual XData Stretch(XData indata) = 0;
+
+    virtual void Update(XData data);
+};
+
+
+#endif //XPLAY_ISTRETCH_H
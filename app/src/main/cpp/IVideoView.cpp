@@ -5,5 +5,155 @@
 void IVideoView::Update(XData data)
 {
     //("IVideoView->Update(data) %d",data.pts);
-    this->Render(data);
+    //帧队列满则等待显示线程消费，先送出之前暂存的帧保持顺序
+    //显示暂停时不再等待（解码线程要进入暂停），剩下的帧暂存
+    std::lock_guard<std::mutex> lock(pendingMux);
+    pending.push_back(data);
+    size_t sent = 0;
+    while(sent < pending.size() && !isExit)
+    {
+        if(frames.Push(pending[sent], 0, 10))
+        {
+            sent++;
+            continue;
+        }
+        if(IsPause()) break;
+    }
+    pending.erase(pending.begin(), pending.begin() + sent);
+}
+
+long long IVideoView::GetPts(XRational &timeBase)
+{
+    std::lock_guard<std::mutex> lock(ptsMux);
+    timeBase = this->timeBase;
+    return pts;
+}
+
+void IVideoView::SetPts(long long pts, XRational timeBase)
+{
+    std::lock_guard<std::mutex> lock(ptsMux);
+    this->pts = pts;
+    this->timeBase = timeBase;
+}
+
+bool IVideoView::Start()
+{
+    frames.SetMax(maxFrame);
+    frames.Open();
+    return XThread::Start();
+}
+
+void IVideoView::Stop()
+{
+    isExit = true;
+    frames.Close();
+    XThread::Stop();
+}
+
+void IVideoView::Wake()
+{
+    frames.Wake();
+}
+
+void IVideoView::ShowFrame(XData frame)
+{
+    stillMux.lock();
+    still = frame;
+    stillMux.unlock();
+    //立即更新显示位置，连续单步以此为准
+    SetPts(frame.pts, frame.timeBase);
+    WakePause();
+}
+
+bool IVideoView::PopFrame(XData &frame)
+{
+    return frames.TryPop(frame);
+}
+
+void IVideoView::Clear()
+{
+    clearCount++;
+    stillMux.lock();
+    still.Drop();
+    stillMux.unlock();
+    pendingMux.lock();
+    for(size_t i = 0; i < pending.size(); i++)
+        pending[i].Drop();
+    pending.clear();
+    pendingMux.unlock();
+    XData d;
+    while(frames.TryPop(d))
+    {
+        d.Drop();
+    }
+    ptsMux.lock();
+    pts = 0;
+    ptsMux.unlock();
+}
+
+void IVideoView::Main()
+{
+    XData frame;
+    int frameClear = 0;
+    while(!isExit)
+    {
+        if(IsPause())
+        {
+            //暂停时只显示拖动或单步送来的单帧
+            stillMux.lock();
+            XData s = std::move(still);
+            stillMux.unlock();
+            if(s.data)
+            {
+                Render(s);
+                SetPts(s.pts, s.timeBase);
+                continue;
+            }
+            WaitPause();
+            continue;
+        }
+
+        //Seek清理后，之前取出的帧不再显示
+        if(frame.data && frameClear != clearCount)
+        {
+            frame.Drop();
+        }
+
+        //取出帧，队列空则阻塞
+        if(!frame.data)
+        {
+            frameClear = clearCount;
+            if(!frames.Pop(frame))
+            {
+                continue;
+            }
+        }
+
+        //按主时钟显示，视频超前则等待到显示时间（等待中可被暂停和退出打断）
+        double waitMs = 0;
+        bool isClock = clock && clock->WaitMs(frame.pts, frame.timeBase, waitMs);
+        if(isClock && waitMs > 0)
+        {
+            WaitTime(waitMs);
+            if(isExit || IsPause()) continue;
+        }
+
+        //已经落后且有后续帧，丢弃不显示（视频主时钟模式下时钟跟随视频，不丢帧）
+        if(isClock && clock->mode != XCLOCK_VIDEO && -waitMs > dropMs && frames.Size() > 0)
+        {
+            dropCount++;
+            frame.Drop();
+            continue;
+        }
+
+        Render(frame);
+        SetPts(frame.pts, frame.timeBase);
+        if(clock) clock->SetVideo(frame.pts, frame.timeBase);
+        if(firstFrameMs < 0 && openBeginMs > 0)
+        {
+            firstFrameMs = XNowMs() - openBeginMs;
+            XLOGI("first frame %.1f ms after open", (double)firstFrameMs);
+        }
+        frame.Drop();
+    }
 }
\ No newline at end of file
@@ -5,14 +5,79 @@
 
 #include "XData.h"
 #include "IObserver.h"
+#include "XQueue.h"
+#include "XClock.h"
 
+//视频显示，解码帧放入帧队列，由独立的显示线程按主时钟显示
 class IVideoView:public IObserver
 {
 public:
     virtual void SetRender(void *win) = 0;
     virtual void Render(XData data) = 0;
+    //解码线程送入帧队列，队列满则阻塞（解码最多领先maxFrame帧）
+    //暂停时不再等待，帧暂存到恢复后的下一次Update送出，不丢弃
     virtual void Update(XData data);
     virtual void Close() = 0;
+
+    //启动显示线程
+    virtual bool Start();
+
+    //关闭帧队列并停止显示线程
+    virtual void Stop();
+
+    //清理帧队列，显示线程确认暂停或已停止后才能调用
+    virtual void Clear();
+
+    //暂停时显示单帧（拖动、单步），由显示线程显示，不更新主时钟
+    virtual void ShowFrame(XData frame);
+
+    //显示线程确认暂停后取出帧队列中下一个待显示的帧（单步），队列空返回false
+    virtual bool PopFrame(XData &frame);
+
+    //帧队列容量
+    int maxFrame = 3;
+
+    //音视频同步主时钟，由播放器注入
+    XMasterClock *clock = 0;
+
+    //最近显示的帧时间（返回值和timeBase为同一帧），显示线程和单步写入(线程安全)
+    long long GetPts(XRational &timeBase);
+
+    //帧落后主时钟超过dropMs（系统时间），且队列中还有后续帧时丢弃不显示
+    int dropMs = 40;
+
+    //本次播放丢弃的帧数
+    std::atomic<int> dropCount{0};
+
+    //首帧耗时统计，播放器打开时设置起点（XNowMs），首帧显示后为起点到显示的毫秒数，未显示为-1
+    double openBeginMs = 0;
+    std::atomic<double> firstFrameMs{-1};
+
+protected:
+    virtual void Main();
+
+    //唤醒阻塞在帧队列中的显示线程
+    virtual void Wake();
+
+    //记录最近显示的帧时间
+    void SetPts(long long pts, XRational timeBase);
+
+    XQueue<XData> frames;
+
+    //暂停时未能送入帧队列的帧，按顺序等待送出（解码线程写入，Clear清理）
+    std::vector<XData> pending;
+    std::mutex pendingMux;
+
+    //最近显示的帧时间（timeBase时间基）
+    long long pts = 0;
+    XRational timeBase;
+    std::mutex ptsMux;
+
+    //暂停时等待显示的单帧
+    XData still;
+    std::mutex stillMux;
+    //每次Clear加一，显示线程丢弃Clear之前取出的帧
+    std::atomic<int> clearCount{0};
 };
 
 
@@ -11,15 +11,59 @@ static SLObjectItf player = NULL;   // 播放器对象
 static SLPlayItf iplayer = NULL;     // 播放器控制接口
 static SLAndroidSimpleBufferQueueItf pcmQue = NULL;  // 音频缓冲队列接口
 
+// 启动队列回调用的静音数据(一个16位立体声样本)
+static unsigned char silence[4] = {0};
+
+// OpenSL ES缓冲队列，作为XPcmTracker的设备
+class SLPcmSink : public XPcmSink {
+public:
+    virtual bool Enqueue(const unsigned char *data, int size) {
+        return pcmQue && (*pcmQue) && (*pcmQue)->Enqueue(pcmQue, data, size) == SL_RESULT_SUCCESS;
+    }
+
+    // 设备报告的队列中缓冲数(SLAndroidSimpleBufferQueueState)
+    virtual int QueuedCount() {
+        SLAndroidSimpleBufferQueueState state;
+        if(!pcmQue || !(*pcmQue) || (*pcmQue)->GetState(pcmQue, &state) != SL_RESULT_SUCCESS)
+            return -1;
+        return (int)state.count;
+    }
+};
+static SLPcmSink slSink;
+
 // 构造函数
 SLAudioPlay::SLAudioPlay() {
-    buf = new unsigned char[1024 * 1024];  // 分配1MB音频缓冲区
 }
 
 // 析构函数
 SLAudioPlay::~SLAudioPlay() {
-    delete[] buf;  // 释放缓冲区
-    buf = 0;
+    ClearInflight();
+}
+
+// 释放所有已入队的缓冲(需在加锁且设备停止读取后调用)
+void SLAudioPlay::ClearInflight() {
+    for(int i = 0; i < inflightCount; i++) {
+        inflight[(inflightHead + i) % QUEUE_SIZE].Drop();
+    }
+    inflightHead = 0;
+    inflightCount = 0;
+    tracker.Sync(0);
+}
+
+// 输出延迟(毫秒)
+int SLAudioPlay::OutputLatencyMs() {
+    mux.lock();
+    int re = (int)tracker.QueuedMs() + latencyMs;
+    mux.unlock();
+    return re;
+}
+
+// 设备队列队首(正在播放)的缓冲时间
+bool SLAudioPlay::PlayingMs(double &ms) {
+    mux.lock();
+    bool re = tracker.PlayingMs(ms);
+    mux.unlock();
+    return re;
 }
 
 // 创建OpenSL ES引擎
@@ -46,7 +90,16 @@ static SLEngineItf CreateSL() {
 void SLAudioPlay::PlayCall(void *bufq) {
     if(!bufq) return;
 
-    SLAndroidSimpleBufferQueueItf bf = (SLAndroidSimpleBufferQueueItf)bufq;
+    // 回调表示最早入队的缓冲已播放完，归还给缓冲池
+    mux.lock();
+    if(inflightCount > 0) {
+        inflight[inflightHead].Drop();
+        inflightHead = (inflightHead + 1) % QUEUE_SIZE;
+        inflightCount--;
+    }
+    // 按设备队列状态同步，此时队首缓冲刚开始播放，队列中剩余时长就是输出延迟
+    tracker.SyncSink(inflightCount);
+    mux.unlock();
 
     // 从音频数据队列获取数据
     XData d = GetData();
@@ -55,19 +108,21 @@ void SLAudioPlay::PlayCall(void *bufq) {
         return;
     }
 
-    if(!buf) return;
-
-    // 复制音频数据到缓冲区
-    memcpy(buf, d.data, d.size);
-
     mux.lock();  // 加锁
-    // 将数据加入OpenSL ES播放队列
-    if(pcmQue && (*pcmQue)) {
-        (*pcmQue)->Enqueue(pcmQue, buf, d.size);
+    // 直接将数据加入OpenSL ES播放队列，播放完成回调后再释放
+    bool isEnqueue = false;
+    if(inflightCount < QUEUE_SIZE) {
+        isEnqueue = tracker.Enqueue(d.data, d.size, XPtsToMs(d.pts, d.timeBase));
+    }
+    if(isEnqueue) {
+        inflight[(inflightHead + inflightCount) % QUEUE_SIZE] = d;
+        inflightCount++;
     }
     mux.unlock();  // 解锁
 
-    d.Drop();  // 释放数据
+    if(!isEnqueue) {
+        d.Drop();  // 入队失败直接释放
+    }
 }
 
 // OpenSL ES缓冲队列回调
@@ -97,6 +152,9 @@ void SLAudioPlay::Close() {
         (*pcmQue)->Clear(pcmQue);
     }
 
+    // 设备已停止读取，释放已入队的缓冲
+    ClearInflight();
+
     // 销毁播放器对象
     if(player && (*player)) {
         (*player)->Destroy(player);
@@ -165,7 +223,7 @@ bool SLAudioPlay::StartPlay(XParameter out) {
     // 缓冲队列定位器
     SLDataLocator_AndroidSimpleBufferQueue que = {
             SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE,
-            10  // 队列缓冲数量
+            QUEUE_SIZE  // 队列缓冲数量
     };
 
     // PCM音频格式配置
@@ -224,10 +282,23 @@ bool SLAudioPlay::StartPlay(XParameter out) {
     // 6. 设置播放状态为播放中
     (*iplayer)->SetPlayState(iplayer, SL_PLAYSTATE_PLAYING);
 
-    // 7. 启动队列回调(发送空数据触发第一次回调)
-    (*pcmQue)->Enqueue(pcmQue, "", 1);
+    // 按输出格式(16位)记录设备队列中的数据时长
+    tracker.Reset(out.sample_rate, out.channels, 2, QUEUE_SIZE);
+    tracker.sink = &slSink;
+
+    // 7. 启动队列回调(发送静音数据触发回调，每个回调入队一帧，保持queueBuffers个缓冲在播放)
+    int count = queueBuffers < 1 ? 1 : (queueBuffers > QUEUE_SIZE ? QUEUE_SIZE : queueBuffers);
+    for(int i = 0; i < count; i++) {
+        if(!tracker.Enqueue(silence, sizeof(silence), -1))
+            break;
+        inflight[(inflightHead + inflightCount) % QUEUE_SIZE] = XData();  // 静音数据无需释放
+        inflightCount++;
+    }
 
     isExit = false;  // 标记播放器运行中
+    frames.SetMax(maxFrame);  // 设置缓冲队列容量
+    frames.SetMaxWeight(maxMs * out.sample_rate / 1000 * out.channels * 2);  // 按时长限制缓冲字节数(16位)
+    frames.Open();   // 重新打开缓冲队列
     mux.unlock();     // 解锁
 
     XLOGI("SLAudioPlay::StartPlay success!");
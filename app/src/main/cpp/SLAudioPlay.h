@@ -2,6 +2,7 @@
 #define XPLAY_SLAUDIOPLAY_H
 
 #include "IAudioPlay.h"  // 包含音频播放接口基类
+#include "XPcmTracker.h" // 设备队列中PCM的时长计算
 
 // SLAudioPlay类 - 基于OpenSL ES的Android音频播放实现
 class SLAudioPlay : public IAudioPlay {
@@ -14,6 +15,12 @@ public:
     // 关闭音频播放并释放资源
     virtual void Close();
 
+    // 输出延迟：设备队列中还未播放完的时长 + 设备固有延迟
+    virtual int OutputLatencyMs();
+
+    // 设备队列队首(正在播放)的缓冲时间(毫秒)
+    virtual bool PlayingMs(double &ms);
+
     // OpenSL ES回调函数
     // bufq: OpenSL ES缓冲队列接口指针
     void PlayCall(void *bufq);
@@ -22,8 +29,21 @@ public:
     // 析构函数
     virtual ~SLAudioPlay();
 
+    // OpenSL ES缓冲队列容量（同时在播放中的最大缓冲数）
+    static const int QUEUE_SIZE = 10;
+
+    // 启动时预先入队的缓冲数（队列深度）
+    int queueBuffers = 4;
+
 protected:
-    unsigned char *buf = 0;  // 音频数据缓冲区
+    // 释放所有已入队的缓冲
+    void ClearInflight();
+
+    // 已入队、设备尚未播放完的数据，按入队顺序回调时归还（直接入队，不拷贝）
+    XData inflight[QUEUE_SIZE];
+    int inflightHead = 0;
+    int inflightCount = 0;
+    XPcmTracker tracker;     // 与设备队列同步的入队记录
     std::mutex mux;          // 线程安全互斥锁
 };
 
@@ -0,0 +1,256 @@
+#include "WSOLAStretch.h"
+#include "XClock.h"
+#include "XLog.h"
+#include <cmath>
+
+#if defined(XSTRETCH_SCALAR)
+//不使用SIMD，基准测试对比用
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define XSTRETCH_NEON
+#elif defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define XSTRETCH_SSE
+#endif
+
+//点积，搜索最佳位置的主要计算量，按平台使用NEON/SSE四路并行
+static float Dot(const float *a, const float *b, int n)
+{
+    int i = 0;
+    float sum = 0;
+#if defined(XSTRETCH_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    for(; i + 8 <= n; i += 8)
+    {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+    float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    sum = vget_lane_f32(vpadd_f32(s, s), 0);
+#elif defined(XSTRETCH_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for(; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float t[4];
+    _mm_storeu_ps(t, _mm_add_ps(acc0, acc1));
+    sum = t[0] + t[1] + t[2] + t[3];
+#endif
+    for(; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+bool WSOLAStretch::Open(XParameter out)
+{
+    mux.lock();
+    sampleRate = out.sample_rate;
+    channels = out.channels;
+    if(sampleRate <= 0 || channels <= 0)
+    {
+        channels = 0;
+        mux.unlock();
+        XLOGE("WSOLAStretch open failed! sample_rate %d channels %d", out.sample_rate, out.channels);
+        return false;
+    }
+    seqFrames = sampleRate * seqMs / 1000;
+    seekFrames = sampleRate * seekMs / 1000;
+    overlapFrames = sampleRate * overlapMs / 1000;
+    //每次约输出一段，0.5倍速时输出是输入的两倍
+    pool.SetBlockSize(seqFrames * channels * 2 * 4);
+    Reset();
+    mux.unlock();
+    return true;
+}
+
+void WSOLAStretch::Close()
+{
+    mux.lock();
+    Reset();
+    channels = 0;
+    mux.unlock();
+}
+
+void WSOLAStretch::Clear()
+{
+    mux.lock();
+    Reset();
+    mux.unlock();
+}
+
+void WSOLAStretch::Reset()
+{
+    input.clear();
+    inPos = 0;
+    mid.clear();
+    hasMid = false;
+    skipFrac = 0;
+    inputMs = 0;
+}
+
+void WSOLAStretch::SetSpeed(double speed)
+{
+    if(speed < 0.5) speed = 0.5;
+    if(speed > 3.0) speed = 3.0;
+    mux.lock();
+    this->speed = speed;
+    mux.unlock();
+}
+
+void WSOLAStretch::CrossFade(const float *p)
+{
+    for(int i = 0; i < overlapFrames; i++)
+    {
+        float t = (float)i / overlapFrames;
+        for(int c = 0; c < channels; c++)
+        {
+            int k = i * channels + c;
+            outBuf.push_back(mid[k] * (1 - t) + p[k] * t);
+        }
+    }
+}
+
+int WSOLAStretch::SeekBest(const float *in)
+{
+    int n = overlapFrames * channels;
+    //归一化互相关，候选段能量按滑动窗口更新
+    double norm = Dot(in, in, n);
+    double bestScore = -1e30;
+    int best = 0;
+    for(int off = 0; off < seekFrames; off++)
+    {
+        const float *p = in + off * channels;
+        double corr = Dot(mid.data(), p, n);
+        double score = corr / std::sqrt(norm + 1.0);
+        if(score > bestScore)
+        {
+            bestScore = score;
+            best = off;
+        }
+        for(int c = 0; c < channels; c++)
+        {
+            norm -= (double)p[c] * p[c];
+            norm += (double)p[n + c] * p[n + c];
+        }
+        if(norm < 0) norm = 0;
+    }
+    return best;
+}
+
+XData WSOLAStretch::Stretch(XData indata)
+{
+    if(indata.size <= 0 || !indata.data) return XData();
+
+    mux.lock();
+    //原速且没有缓存，直接透传
+    if(!channels || (speed == 1.0 && (int)input.size() == inPos * channels && !hasMid))
+    {
+        mux.unlock();
+        return indata;
+    }
+
+    int frames = indata.size / (2 * channels);
+    const short *pcm = (const short *)indata.data;
+    if((int)input.size() == inPos * channels)
+    {
+        input.clear();
+        inPos = 0;
+        inputMs = XPtsToMs(indata.pts, indata.timeBase);
+    }
+    timeBase = indata.timeBase;
+    input.insert(input.end(), pcm, pcm + frames * channels);
+
+    outBuf.clear();
+    double outMs = inputMs;
+    int inFrames = (int)input.size() / channels - inPos;
+
+    if(speed == 1.0)
+    {
+        //恢复原速：上一段的延续mid与当前输入不连续，搜索最相似的位置交叉淡化衔接，之后回到透传
+        //输入不足以搜索时先缓存
+        if(!hasMid)
+        {
+            outBuf.insert(outBuf.end(), input.begin() + inPos * channels, input.end());
+            Reset();
+        }
+        else if(inFrames > overlapFrames + seekFrames)
+        {
+            const float *p = input.data() + (inPos + SeekBest(input.data() + inPos * channels)) * channels;
+            CrossFade(p);
+            outBuf.insert(outBuf.end(), p + overlapFrames * channels, (const float *)input.data() + input.size());
+            Reset();
+        }
+    }
+    else
+    {
+        int ov = overlapFrames * channels;
+        int outFrames = seqFrames - overlapFrames;
+        while(true)
+        {
+            double skip = outFrames * speed + skipFrac;
+            int skipFrames = (int)skip;
+            if(inFrames < seqFrames + seekFrames || inFrames < skipFrames) break;
+
+            const float *in = input.data() + inPos * channels;
+            int off = hasMid ? SeekBest(in) : 0;
+            const float *p = in + off * channels;
+
+            //重叠部分交叉淡化，之后直接复制
+            if(hasMid)
+            {
+                CrossFade(p);
+            }
+            else
+            {
+                outBuf.insert(outBuf.end(), p, p + ov);
+            }
+            outBuf.insert(outBuf.end(), p + ov, p + (seqFrames - overlapFrames) * channels);
+            mid.assign(p + (seqFrames - overlapFrames) * channels, p + seqFrames * channels);
+            hasMid = true;
+
+            skipFrac = skip - skipFrames;
+            inPos += skipFrames;
+            inFrames -= skipFrames;
+            inputMs += skipFrames * 1000.0 / sampleRate;
+        }
+        //已处理的输入移到前面
+        if(inPos > 0)
+        {
+            input.erase(input.begin(), input.begin() + inPos * channels);
+            inPos = 0;
+        }
+    }
+
+    if(outBuf.empty())
+    {
+        mux.unlock();
+        return XData();
+    }
+
+    XData out;
+    int outSize = (int)outBuf.size() * 2;
+    if(!out.Alloc(&pool, outSize))
+    {
+        mux.unlock();
+        return XData();
+    }
+    short *dst = (short *)out.data;
+    for(size_t i = 0; i < outBuf.size(); i++)
+    {
+        float v = outBuf[i];
+        if(v > 32767) v = 32767;
+        if(v < -32768) v = -32768;
+        dst[i] = (short)lrintf(v);
+    }
+    out.timeBase = timeBase;
+    out.pts = XMsToPts(outMs, timeBase);
+    out.dts = out.pts;
+    out.isAudio = indata.isAudio;
+    mux.unlock();
+    return out;
+}
@@ -0,0 +1,60 @@
+#ifndef XPLAY_WSOLASTRETCH_H
+#define XPLAY_WSOLASTRETCH_H
+
+#include "IStretch.h"
+#include "XBufferPool.h"
+#include <vector>
+#include <mutex>
+
+//WSOLA 变速不变调
+//每次输出一段(seqMs)，在输入中按速度跳过对应的长度，
+//并在seekMs范围内搜索与上一段自然延续最相似的位置，重叠部分(overlapMs)交叉淡化
+class WSOLAStretch: public IStretch
+{
+public:
+    virtual bool Open(XParameter out);
+    virtual void Close();
+    virtual void Clear();
+    virtual void SetSpeed(double speed);
+    virtual XData Stretch(XData indata);
+
+    //分段参数（毫秒），Open前设置
+    int seqMs = 40;
+    int seekMs = 15;
+    int overlapMs = 8;
+
+protected:
+    //在搜索范围内找与mid最相似的输入位置（帧）
+    int SeekBest(const float *in);
+    //mid与p的重叠部分交叉淡化，写入outBuf
+    void CrossFade(const float *p);
+    void Reset();
+
+    int sampleRate = 0;
+    int channels = 0;
+    double speed = 1.0;
+
+    int seqFrames = 0;
+    int seekFrames = 0;
+    int overlapFrames = 0;
+
+    //未处理的输入，从inPos帧开始有效
+    std::vector<float> input;
+    int inPos = 0;
+    //上一段输出之后的自然延续，用于搜索和交叉淡化
+    std::vector<float> mid;
+    bool hasMid = false;
+    //按速度跳过输入时的小数部分
+    double skipFrac = 0;
+    //input[inPos]的时间（毫秒）
+    double inputMs = 0;
+    XRational timeBase;
+
+    std::vector<float> outBuf;
+    //输出PCM缓冲池
+    XBufferPool pool;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_WSOLASTRETCH_H
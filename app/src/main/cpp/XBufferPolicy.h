@@ -0,0 +1,23 @@
+#ifndef XPLAY_XBUFFERPOLICY_H
+#define XPLAY_XBUFFERPOLICY_H
+
+//缓冲策略，按媒体时长（毫秒）和字节数限制，高低水位滞回
+//单个流达到高水位（时长或字节任一项）后标记为满，
+//降到低水位以下（时长和字节都低于）才恢复为未满
+struct XBufferPolicy
+{
+    //高水位
+    int highMs = 2000;
+    int highBytes = 8 * 1024 * 1024;
+
+    //低水位
+    int lowMs = 1000;
+    int lowBytes = 4 * 1024 * 1024;
+
+    //单个流的硬上限，任一流达到即停止读取，限制内存
+    int maxMs = 10000;
+    int maxBytes = 24 * 1024 * 1024;
+};
+
+
+#endif //XPLAY_XBUFFERPOLICY_H
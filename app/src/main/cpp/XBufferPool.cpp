@@ -0,0 +1,82 @@
+#include "XBufferPool.h"
+
+//每块前面存放块大小，用于判断归还的块是否还是当前尺寸
+static const int HEAD_SIZE = 16;
+
+static unsigned char *Head(unsigned char *p)
+{
+    return p - HEAD_SIZE;
+}
+
+XBufferPool::~XBufferPool()
+{
+    ClearIdle();
+}
+
+void XBufferPool::ClearIdle()
+{
+    for(size_t i = 0; i < idles.size(); i++)
+    {
+        delete [] Head(idles[i]);
+    }
+    idles.clear();
+}
+
+void XBufferPool::SetBlockSize(int size)
+{
+    mux.lock();
+    if(size != blockSize)
+    {
+        ClearIdle();
+        blockSize = size;
+    }
+    mux.unlock();
+}
+
+int XBufferPool::GetBlockSize()
+{
+    mux.lock();
+    int re = blockSize;
+    mux.unlock();
+    return re;
+}
+
+unsigned char *XBufferPool::Alloc(int size)
+{
+    if(size <= 0) return 0;
+    mux.lock();
+    if(size > blockSize)
+    {
+        ClearIdle();
+        blockSize = size;
+    }
+    if(!idles.empty())
+    {
+        unsigned char *p = idles.back();
+        idles.pop_back();
+        reuses++;
+        mux.unlock();
+        return p;
+    }
+    int bsize = blockSize;
+    allocs++;
+    mux.unlock();
+
+    unsigned char *head = new unsigned char[bsize + HEAD_SIZE];
+    *(int *)head = bsize;
+    return head + HEAD_SIZE;
+}
+
+void XBufferPool::Free(unsigned char *p)
+{
+    if(!p) return;
+    mux.lock();
+    if(*(int *)Head(p) == blockSize && (int)idles.size() < maxIdle)
+    {
+        idles.push_back(p);
+        mux.unlock();
+        return;
+    }
+    mux.unlock();
+    delete [] Head(p);
+}
\ No newline at end of file
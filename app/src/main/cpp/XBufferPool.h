@@ -0,0 +1,38 @@
+#ifndef XPLAY_XBUFFERPOOL_H
+#define XPLAY_XBUFFERPOOL_H
+
+#include <vector>
+#include <mutex>
+
+//固定大小内存块池（线程安全）
+//块大小改变后，归还的旧尺寸块直接释放
+class XBufferPool
+{
+public:
+    ~XBufferPool();
+
+    //设置块大小，清理空闲块
+    void SetBlockSize(int size);
+    int GetBlockSize();
+
+    //取出一块，size超过块大小时按size扩大块大小
+    unsigned char *Alloc(int size);
+
+    //归还
+    void Free(unsigned char *p);
+
+    //分配次数与复用次数
+    long long allocs = 0;
+    long long reuses = 0;
+
+    //池中最多保留的空闲块数
+    int maxIdle = 64;
+protected:
+    void ClearIdle();
+    std::vector<unsigned char *> idles;
+    int blockSize = 0;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XBUFFERPOOL_H
@@ -0,0 +1,227 @@
+#include "XClock.h"
+#include <chrono>
+extern "C"{
+#include <libavutil/avutil.h>
+#include <libavutil/mathematics.h>
+}
+
+using namespace std;
+
+double XNowMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double XPtsToMs(long long pts, XRational timeBase)
+{
+    if(pts == AV_NOPTS_VALUE || timeBase.num <= 0 || timeBase.den <= 0) return 0;
+    //先换算到微秒整数，避免浮点累积误差
+    AVRational tb = {timeBase.num, timeBase.den};
+    AVRational us = {1, 1000000};
+    return av_rescale_q(pts, tb, us) / 1000.0;
+}
+
+bool XPtsValid(long long pts)
+{
+    return pts != AV_NOPTS_VALUE;
+}
+
+long long XMsToPts(double ms, XRational timeBase)
+{
+    if(timeBase.num <= 0 || timeBase.den <= 0) return 0;
+    AVRational tb = {timeBase.num, timeBase.den};
+    AVRational us = {1, 1000000};
+    return av_rescale_q((long long)(ms * 1000), us, tb);
+}
+
+double XPtsToPos(long long pts, XRational timeBase, long long totalMs)
+{
+    if(totalMs <= 0) return 0;
+    return XPtsToMs(pts, timeBase) / (double)totalMs;
+}
+
+long long XPosToPts(double pos, long long totalMs, XRational timeBase)
+{
+    return XMsToPts(pos * (double)totalMs, timeBase);
+}
+
+void XClock::Set(double pts)
+{
+    mux.lock();
+    this->pts = pts;
+    updateMs = XNowMs();
+    isSet = true;
+    mux.unlock();
+}
+
+bool XClock::Get(double &pts)
+{
+    mux.lock();
+    if(!isSet)
+    {
+        mux.unlock();
+        return false;
+    }
+    pts = this->pts;
+    //两次更新之间按经过的时间插值
+    if(!isPause)
+        pts += (XNowMs() - updateMs) * speed;
+    mux.unlock();
+    return true;
+}
+
+bool XClock::IsSet()
+{
+    mux.lock();
+    bool re = isSet;
+    mux.unlock();
+    return re;
+}
+
+void XClock::SetPause(bool isP)
+{
+    mux.lock();
+    if(isP == isPause)
+    {
+        mux.unlock();
+        return;
+    }
+    double now = XNowMs();
+    //暂停时固定当前时间，恢复时从当前系统时间重新计时
+    if(isP && isSet)
+        pts += (now - updateMs) * speed;
+    updateMs = now;
+    isPause = isP;
+    mux.unlock();
+}
+
+void XClock::SetSpeed(double speed)
+{
+    mux.lock();
+    double now = XNowMs();
+    if(isSet && !isPause)
+        pts += (now - updateMs) * this->speed;
+    updateMs = now;
+    this->speed = speed;
+    mux.unlock();
+}
+
+void XClock::Reset()
+{
+    mux.lock();
+    pts = 0;
+    updateMs = 0;
+    isSet = false;
+    mux.unlock();
+}
+
+bool XMasterClock::Get(double &pts)
+{
+    switch(mode)
+    {
+        case XCLOCK_AUDIO:
+            //没有音频（或音频还没开始）时使用外部时钟
+            if(audio.Get(pts)) return true;
+            return external.Get(pts);
+        case XCLOCK_VIDEO:
+            return video.Get(pts);
+        default:
+            return external.Get(pts);
+    }
+}
+
+void XMasterClock::SetAudio(double pts)
+{
+    audio.Set(pts);
+    Start(pts);
+}
+
+void XMasterClock::SetAudio(double ms, double delayMs)
+{
+    SetAudio(ms - delayMs * GetSpeed());
+}
+
+void XMasterClock::SetAudio(long long pts, XRational timeBase, double delayMs)
+{
+    SetAudio(XPtsToMs(pts, timeBase), delayMs);
+}
+
+void XMasterClock::SetVideo(long long pts, XRational timeBase)
+{
+    SetVideo(XPtsToMs(pts, timeBase));
+}
+
+bool XMasterClock::WaitMs(long long pts, XRational timeBase, double &waitMs)
+{
+    double now = 0;
+    if(!Get(now)) return false;
+    //时钟按播放速度走动，等待的系统时间按速度缩短
+    waitMs = (XPtsToMs(pts, timeBase) - now) / GetSpeed();
+    return true;
+}
+
+void XMasterClock::SetVideo(double pts)
+{
+    double apts = 0;
+    if(audio.Get(apts))
+    {
+        mux.lock();
+        drift = pts - apts;
+        mux.unlock();
+    }
+
+    //视频主时钟由第一帧启动，之后自由走动，落后太多时跟随视频
+    double vpts = 0;
+    if(!video.Get(vpts) || (mode == XCLOCK_VIDEO && vpts - pts > videoResetMs))
+        video.Set(pts);
+    Start(pts);
+}
+
+void XMasterClock::Start(double pts)
+{
+    if(!external.IsSet())
+        external.Set(pts);
+}
+
+void XMasterClock::SetPause(bool isP)
+{
+    audio.SetPause(isP);
+    video.SetPause(isP);
+    external.SetPause(isP);
+}
+
+void XMasterClock::Reset()
+{
+    audio.Reset();
+    video.Reset();
+    external.Reset();
+    mux.lock();
+    drift = 0;
+    mux.unlock();
+}
+
+void XMasterClock::SetSpeed(double speed)
+{
+    audio.SetSpeed(speed);
+    video.SetSpeed(speed);
+    external.SetSpeed(speed);
+    mux.lock();
+    this->speed = speed;
+    mux.unlock();
+}
+
+double XMasterClock::GetSpeed()
+{
+    mux.lock();
+    double re = speed;
+    mux.unlock();
+    return re;
+}
+
+double XMasterClock::GetDrift()
+{
+    mux.lock();
+    double re = drift;
+    mux.unlock();
+    return re;
+}
\ No newline at end of file
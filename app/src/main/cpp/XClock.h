@@ -0,0 +1,118 @@
+#ifndef XPLAY_XCLOCK_H
+#define XPLAY_XCLOCK_H
+
+#include <mutex>
+#include "XData.h"
+
+//当前系统时间（毫秒，单调递增）
+double XNowMs();
+
+//时间戳换算为毫秒，各模块保留流时间基的原始pts，只在同步和显示位置时换算
+//无效时间戳返回0
+double XPtsToMs(long long pts, XRational timeBase);
+
+//时间戳是否有效（不是AV_NOPTS_VALUE）
+bool XPtsValid(long long pts);
+
+//毫秒换算为时间基下的时间戳
+long long XMsToPts(double ms, XRational timeBase);
+
+//时间戳在总时长（毫秒）中的位置 0.0~1.0，没有时长返回0
+double XPtsToPos(long long pts, XRational timeBase, long long totalMs);
+
+//位置 0.0~1.0 换算为时间基下的时间戳
+long long XPosToPts(double pos, long long totalMs, XRational timeBase);
+
+//播放时钟（线程安全），记录最近一次更新的pts和系统时间，
+//读取时按经过的时间插值，暂停时停止走动
+class XClock
+{
+public:
+    //更新时钟 pts 毫秒
+    void Set(double pts);
+
+    //当前时间（毫秒），未设置返回false
+    bool Get(double &pts);
+
+    bool IsSet();
+
+    void SetPause(bool isP);
+
+    //走动速度，从当前时间开始按新速度插值
+    void SetSpeed(double speed);
+
+    //清理，再次打开文件或seek时调用
+    void Reset();
+
+protected:
+    double pts = 0;
+    double speed = 1.0;
+    //更新时的系统时间
+    double updateMs = 0;
+    bool isSet = false;
+    bool isPause = false;
+    std::mutex mux;
+};
+
+//主时钟模式
+enum XClockMode
+{
+    XCLOCK_AUDIO = 0,       //以音频播放位置为准，视频跟随
+    XCLOCK_VIDEO = 1,       //以视频显示为准，视频落后时时钟跟随视频
+    XCLOCK_EXTERNAL = 2     //系统时钟，由第一个数据开始走动，不做调整
+};
+
+//音视频同步主时钟
+class XMasterClock
+{
+public:
+    //主时钟当前时间（毫秒），未开始返回false
+    bool Get(double &pts);
+
+    //音频输出更新（已扣除输出延迟的正在播放位置）
+    void SetAudio(double pts);
+
+    //音频输出更新，ms为正在输出的数据时间（毫秒），delayMs为之后才能听到的系统时间（毫秒）
+    //变速时延迟对应的媒体时长按速度换算
+    void SetAudio(double ms, double delayMs);
+
+    //音频输出更新，pts为送入输出的数据时间戳
+    void SetAudio(long long pts, XRational timeBase, double delayMs);
+
+    //视频显示一帧后更新，记录音视频偏差
+    void SetVideo(double pts);
+    void SetVideo(long long pts, XRational timeBase);
+
+    //时间戳距离主时钟还要等待的系统时间（毫秒，按播放速度换算），负数为已经落后
+    //主时钟未开始返回false
+    bool WaitMs(long long pts, XRational timeBase, double &waitMs);
+
+    //主时钟未开始时，由第一个数据启动外部时钟
+    void Start(double pts);
+
+    void SetPause(bool isP);
+    void Reset();
+
+    //播放速度，时钟按该倍数走动
+    void SetSpeed(double speed);
+    double GetSpeed();
+
+    //音视频偏差（毫秒，视频显示的帧时间减去音频正在播放的时间，正数视频超前）
+    double GetDrift();
+
+    XClockMode mode = XCLOCK_AUDIO;
+
+    //视频主时钟模式下，视频落后超过该值（毫秒）时钟跟随视频
+    int videoResetMs = 100;
+
+    XClock audio;
+    XClock video;
+    XClock external;
+protected:
+    double drift = 0;
+    double speed = 1.0;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XCLOCK_H
@@ -1,8 +1,111 @@
 #include "XData.h"
+#include "XPacketPool.h"
+#include "XFramePool.h"
+#include "XBufferPool.h"
+#include <atomic>
+#include <vector>
+#include <mutex>
 extern "C"{
 #include <libavformat/avformat.h>
 }
 
+struct XDataRef
+{
+    std::atomic<int> count;
+};
+
+//引用计数块复用，避免每个数据包分配
+static std::mutex refMux;
+static std::vector<XDataRef *> refIdles;
+
+static XDataRef *NewRef()
+{
+    XDataRef *ref = 0;
+    refMux.lock();
+    if(!refIdles.empty())
+    {
+        ref = refIdles.back();
+        refIdles.pop_back();
+    }
+    refMux.unlock();
+    if(!ref) ref = new XDataRef();
+    ref->count = 1;
+    return ref;
+}
+
+static void FreeRef(XDataRef *ref)
+{
+    refMux.lock();
+    refIdles.push_back(ref);
+    refMux.unlock();
+}
+
+XData::XData(const XData &d)
+{
+    *this = d;
+}
+
+XData::XData(XData &&d)
+{
+    *this = std::move(d);
+}
+
+XData &XData::operator=(const XData &d)
+{
+    if(this == &d) return *this;
+    if(d.ref) d.ref->count++;
+    Drop();
+    type = d.type;
+    pts = d.pts;
+    dts = d.dts;
+    timeBase = d.timeBase;
+    data = d.data;
+    for(int i = 0; i < 8; i++) datas[i] = d.datas[i];
+    size = d.size;
+    isAudio = d.isAudio;
+    isKey = d.isKey;
+    width = d.width;
+    height = d.height;
+    format = d.format;
+    pool = d.pool;
+    ref = d.ref;
+    return *this;
+}
+
+XData &XData::operator=(XData &&d)
+{
+    if(this == &d) return *this;
+    Drop();
+    type = d.type;
+    pts = d.pts;
+    dts = d.dts;
+    timeBase = d.timeBase;
+    data = d.data;
+    for(int i = 0; i < 8; i++) datas[i] = d.datas[i];
+    size = d.size;
+    isAudio = d.isAudio;
+    isKey = d.isKey;
+    width = d.width;
+    height = d.height;
+    format = d.format;
+    pool = d.pool;
+    ref = d.ref;
+    d.ref = 0;
+    d.data = 0;
+    d.size = 0;
+    return *this;
+}
+
+XData::~XData()
+{
+    Drop();
+}
+
+int XData::RefCount() const
+{
+    return ref ? (int)ref->count : 0;
+}
+
 bool XData::Alloc(int size,const char *d)
 {
     Drop();
@@ -15,15 +118,47 @@ bool XData::Alloc(int size,const char *d)
         memcpy(this->data,d,size);
     }
     this->size = size;
+    ref = NewRef();
+    return true;
+}
+bool XData::Alloc(XBufferPool *pool,int size)
+{
+    Drop();
+    if(!pool || size <= 0) return false;
+    type = POOL_TYPE;
+    this->data = pool->Alloc(size);
+    if(!this->data) return false;
+    this->pool = pool;
+    this->size = size;
+    ref = NewRef();
     return true;
 }
+void XData::Attach(XDataType type,unsigned char *data,int size)
+{
+    Drop();
+    if(!data) return;
+    this->type = type;
+    this->data = data;
+    this->size = size;
+    ref = NewRef();
+}
 void XData::Drop()
 {
     if(!data) return;
-    if(type == AVPACKET_TYPE)
-        av_packet_free((AVPacket **)&data);
-    else
-        delete data;
+    //最后一个引用才释放数据，不拥有的数据只清理指针
+    if(ref && --ref->count == 0)
+    {
+        if(type == AVPACKET_TYPE)
+            XPacketPool::Get()->Free((AVPacket **)&data);
+        else if(type == AVFRAME_TYPE)
+            XFramePool::Get()->Free((AVFrame **)&data);
+        else if(type == POOL_TYPE)
+            pool->Free(data);
+        else
+            delete [] data;
+        FreeRef(ref);
+    }
+    ref = 0;
     data = 0;
     size = 0;
 }
\ No newline at end of file
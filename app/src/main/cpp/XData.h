@@ -1,25 +1,62 @@
 #ifndef XPLAY_XDATA_H
 #define XPLAY_XDATA_H
+class XBufferPool;
+struct XDataRef;
+
 enum XDataType
 {
     AVPACKET_TYPE = 0,
-    UCHAR_TYPE = 1
+    UCHAR_TYPE = 1,
+    POOL_TYPE = 2,
+    AVFRAME_TYPE = 3
 };
 
+//时间基，与AVRational相同，时间 = pts * num / den 秒
+struct XRational
+{
+    int num = 1;
+    int den = 1000;
+};
 
+
+//数据共享引用计数，复制增加引用，Drop或析构释放本对象的引用，
+//最后一个引用释放时才清理数据，可以同时交给多个观察者
 struct XData
 {
     int type = 0;
-    int pts = 0;
+    //流时间基下的原始时间戳，由时钟层按timeBase换算为毫秒
+    long long pts = 0;
+    long long dts = 0;
+    XRational timeBase;
     unsigned char *data = 0;
     unsigned char *datas[8] = {0};
     int size = 0;
     bool isAudio = false;
+    //关键帧（视频包或解码后的帧）
+    bool isKey = false;
     int width = 0;
     int height = 0;
     int format = 0;
+    //POOL_TYPE 数据所属的缓冲池
+    XBufferPool *pool = 0;
     bool Alloc(int size,const char *data=0);
+    //从缓冲池取出内存
+    bool Alloc(XBufferPool *pool,int size);
+    //接管外部分配的数据(AVPacket AVFrame)，由最后一个引用释放
+    void Attach(XDataType type,unsigned char *data,int size);
+    //释放本对象的引用
     void Drop();
+    //当前引用数，不拥有数据返回0
+    int RefCount() const;
+
+    XData() {}
+    XData(const XData &d);
+    XData(XData &&d);
+    XData &operator=(const XData &d);
+    XData &operator=(XData &&d);
+    ~XData();
+protected:
+    XDataRef *ref = 0;
 };
 
 
@@ -0,0 +1,405 @@
+#include "XDiskCache.h"
+#include "XLog.h"
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+//索引文件格式版本
+static const unsigned int INDEX_MAGIC = 0x32434458; //"XDC2"
+//新写入多少块保存一次索引，异常退出时最多丢失这些块的记录
+static const int SAVE_BLOCKS = 16;
+
+unsigned long long XDiskCache::Hash(const unsigned char *data, int size)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for(int i = 0; i < size; i++)
+    {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string XDiskCache::UrlKey(const char *url)
+{
+    char buf[17] = {0};
+    snprintf(buf, sizeof(buf), "%016llx", Hash((const unsigned char *)url, (int)strlen(url)));
+    return buf;
+}
+
+static bool WriteAll(FILE *fp, const void *data, size_t size)
+{
+    return size == 0 || fwrite(data, 1, size, fp) == size;
+}
+
+static bool ReadAll(FILE *fp, void *data, size_t size)
+{
+    return size == 0 || fread(data, 1, size, fp) == size;
+}
+
+bool XDiskCache::SetDir(const char *dir)
+{
+    std::lock_guard<std::mutex> lock(mux);
+    for(auto &it : entries)
+    {
+        if(it.second->refs > 0)
+        {
+            XLOGE("XDiskCache SetDir failed! %s is open", it.second->url.c_str());
+            return false;
+        }
+    }
+    for(auto &it : entries)
+        delete it.second;
+    entries.clear();
+    bytes = 0;
+    this->dir.clear();
+    if(!dir || !dir[0]) return true;
+
+    if(mkdir(dir, 0700) != 0 && errno != EEXIST)
+    {
+        XLOGE("XDiskCache mkdir %s failed!", dir);
+        return false;
+    }
+    DIR *d = opendir(dir);
+    if(!d)
+    {
+        XLOGE("XDiskCache opendir %s failed!", dir);
+        return false;
+    }
+    this->dir = dir;
+
+    std::vector<std::string> idxs;
+    std::vector<std::string> datas;
+    while(dirent *ent = readdir(d))
+    {
+        std::string name = ent->d_name;
+        size_t dot = name.rfind('.');
+        if(dot == std::string::npos) continue;
+        std::string ext = name.substr(dot);
+        if(ext == ".idx") idxs.push_back(name.substr(0, dot));
+        else if(ext == ".data") datas.push_back(name.substr(0, dot));
+        else if(ext == ".tmp") unlink((this->dir + "/" + name).c_str());
+    }
+    closedir(d);
+
+    for(const std::string &key : idxs)
+    {
+        if(entries.find(key) == entries.end() && !Load(key))
+            unlink((this->dir + "/" + key + ".idx").c_str());
+    }
+    //没有索引的数据文件无法使用
+    for(const std::string &key : datas)
+    {
+        if(entries.find(key) == entries.end())
+            unlink((this->dir + "/" + key + ".data").c_str());
+    }
+    Evict(0);
+    XLOGI("XDiskCache dir %s entries %d bytes %lld", dir, (int)entries.size(), bytes);
+    return true;
+}
+
+void XDiskCache::SetMaxBytes(long long bytes)
+{
+    std::lock_guard<std::mutex> lock(mux);
+    maxBytes = bytes;
+    Evict(0);
+}
+
+bool XDiskCache::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(mux);
+    return !dir.empty() && maxBytes > 0;
+}
+
+bool XDiskCache::Load(const std::string &key)
+{
+    std::string path = dir + "/" + key;
+    struct stat st;
+    if(stat((path + ".data").c_str(), &st) != 0) return false;
+    FILE *fp = fopen((path + ".idx").c_str(), "rb");
+    if(!fp) return false;
+
+    XDiskEntry *e = new XDiskEntry();
+    e->key = key;
+    e->path = path;
+    unsigned int magic = 0;
+    int urlLen = 0;
+    long long count = 0;
+    bool re = ReadAll(fp, &magic, sizeof(magic)) && magic == INDEX_MAGIC
+              && ReadAll(fp, &e->blockSize, sizeof(e->blockSize)) && e->blockSize > 0
+              && ReadAll(fp, &e->size, sizeof(e->size))
+              && ReadAll(fp, &e->fingerprint, sizeof(e->fingerprint))
+              && ReadAll(fp, &e->lastUse, sizeof(e->lastUse))
+              && ReadAll(fp, &urlLen, sizeof(urlLen)) && urlLen >= 0 && urlLen < 64 * 1024;
+    if(re)
+    {
+        e->url.resize(urlLen);
+        re = ReadAll(fp, &e->url[0], urlLen)
+             && ReadAll(fp, &count, sizeof(count))
+             && count >= 0 && e->size >= 0 && count == (e->size + e->blockSize - 1) / e->blockSize;
+    }
+    if(re)
+    {
+        e->marks.resize(count);
+        re = ReadAll(fp, e->marks.data(), count);
+    }
+    fclose(fp);
+    if(!re)
+    {
+        delete e;
+        unlink((path + ".data").c_str());
+        return false;
+    }
+    for(long long i = 0; i < count; i++)
+    {
+        if(e->marks[i] > 1) e->marks[i] = 0;
+        if(e->marks[i]) e->bytes += BlockBytes(e, i);
+    }
+    bytes += e->bytes;
+    entries[key] = e;
+    return true;
+}
+
+void XDiskCache::Save(XDiskEntry *e)
+{
+    e->dirty = 0;
+    std::string tmp = e->path + ".idx.tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if(!fp) return;
+    int urlLen = (int)e->url.size();
+    long long count = (long long)e->marks.size();
+    //正在写入的块还没有数据，记为未缓存
+    std::vector<unsigned char> marks(e->marks);
+    for(size_t i = 0; i < marks.size(); i++)
+    {
+        if(marks[i] != 1) marks[i] = 0;
+    }
+    bool re = WriteAll(fp, &INDEX_MAGIC, sizeof(INDEX_MAGIC))
+              && WriteAll(fp, &e->blockSize, sizeof(e->blockSize))
+              && WriteAll(fp, &e->size, sizeof(e->size))
+              && WriteAll(fp, &e->fingerprint, sizeof(e->fingerprint))
+              && WriteAll(fp, &e->lastUse, sizeof(e->lastUse))
+              && WriteAll(fp, &urlLen, sizeof(urlLen))
+              && WriteAll(fp, e->url.data(), urlLen)
+              && WriteAll(fp, &count, sizeof(count))
+              && WriteAll(fp, marks.data(), count);
+    re = fclose(fp) == 0 && re;
+    //改名是原子的，索引不会只写一半
+    if(!re || rename(tmp.c_str(), (e->path + ".idx").c_str()) != 0)
+        unlink(tmp.c_str());
+}
+
+long long XDiskCache::BlockBytes(XDiskEntry *e, long long index)
+{
+    long long n = e->size - index * e->blockSize;
+    return n < e->blockSize ? n : e->blockSize;
+}
+
+void XDiskCache::Reset(XDiskEntry *e)
+{
+    bytes -= e->bytes;
+    e->bytes = 0;
+    e->marks.assign(e->marks.size(), 0);
+    //锁外进行中的读写完成后发现版本变化，丢弃结果
+    e->generation++;
+    if(e->fd >= 0 && ftruncate(e->fd, 0) != 0)
+        XLOGE("XDiskCache truncate %s failed!", e->path.c_str());
+}
+
+void XDiskCache::Remove(XDiskEntry *e)
+{
+    if(e->fd >= 0) close(e->fd);
+    unlink((e->path + ".data").c_str());
+    unlink((e->path + ".idx").c_str());
+    bytes -= e->bytes;
+    entries.erase(e->key);
+    delete e;
+}
+
+bool XDiskCache::Evict(long long need)
+{
+    while(bytes + need > maxBytes)
+    {
+        XDiskEntry *old = 0;
+        for(auto &it : entries)
+        {
+            XDiskEntry *e = it.second;
+            if(e->refs > 0) continue;
+            if(!old || e->lastUse < old->lastUse)
+                old = e;
+        }
+        //剩下的都在播放中
+        if(!old) return false;
+        XLOGI("XDiskCache evict %s %lld bytes", old->url.c_str(), old->bytes);
+        Remove(old);
+        evicts++;
+    }
+    return true;
+}
+
+XDiskEntry *XDiskCache::Open(const char *url, int blockSize)
+{
+    std::lock_guard<std::mutex> lock(mux);
+    if(!url || blockSize <= 0 || dir.empty() || maxBytes <= 0) return 0;
+
+    std::string key = UrlKey(url);
+    XDiskEntry *e = 0;
+    auto it = entries.find(key);
+    if(it != entries.end())
+    {
+        e = it->second;
+        //哈希冲突或块大小改变，旧数据不能使用
+        if(e->url != url || e->blockSize != blockSize)
+        {
+            if(e->refs > 0) return 0;
+            Remove(e);
+            e = 0;
+        }
+    }
+    if(!e)
+    {
+        e = new XDiskEntry();
+        e->key = key;
+        e->url = url;
+        e->path = dir + "/" + key;
+        e->blockSize = blockSize;
+        entries[key] = e;
+    }
+    if(e->fd < 0)
+    {
+        e->fd = open((e->path + ".data").c_str(), O_RDWR | O_CREAT, 0600);
+        if(e->fd < 0)
+        {
+            XLOGE("XDiskCache open %s.data failed!", e->path.c_str());
+            if(e->refs == 0) Remove(e);
+            return 0;
+        }
+    }
+    e->refs++;
+    e->lastUse = time(0);
+    return e;
+}
+
+void XDiskCache::Close(XDiskEntry *e)
+{
+    if(!e) return;
+    std::lock_guard<std::mutex> lock(mux);
+    if(--e->refs > 0) return;
+    //大小未知，无法使用的资源不保留
+    if(e->size < 0 || e->bytes == 0)
+    {
+        Remove(e);
+        return;
+    }
+    Save(e);
+    close(e->fd);
+    e->fd = -1;
+}
+
+bool XDiskCache::Validate(XDiskEntry *e, long long size, unsigned long long fingerprint)
+{
+    if(!e) return true;
+    std::lock_guard<std::mutex> lock(mux);
+    if(e->size == size && e->fingerprint == fingerprint) return true;
+    bool isChanged = e->size >= 0;
+    if(isChanged)
+        XLOGI("XDiskCache %s changed, size %lld -> %lld, reset", e->url.c_str(), e->size, size);
+    Reset(e);
+    e->size = size;
+    e->fingerprint = fingerprint;
+    if(size < 0)
+    {
+        e->marks.clear();
+        return !isChanged;
+    }
+    e->marks.assign((size + e->blockSize - 1) / e->blockSize, 0);
+    Save(e);
+    return !isChanged;
+}
+
+long long XDiskCache::GetSize(XDiskEntry *e)
+{
+    if(!e) return -1;
+    std::lock_guard<std::mutex> lock(mux);
+    return e->size;
+}
+
+int XDiskCache::Read(XDiskEntry *e, long long index, unsigned char *buf)
+{
+    if(!e) return -1;
+    std::unique_lock<std::mutex> lock(mux);
+    if(index < 0 || index >= (long long)e->marks.size() || e->marks[index] != 1) return -1;
+    int n = (int)BlockBytes(e, index);
+    int fd = e->fd;
+    int gen = e->generation;
+    lock.unlock();
+
+    //打开中的资源不会被淘汰，fd在Close前有效
+    bool re = pread(fd, buf, n, index * e->blockSize) == n;
+
+    lock.lock();
+    //读取期间资源被清空，数据无效
+    if(gen != e->generation || e->marks[index] != 1) return -1;
+    if(!re)
+    {
+        //数据文件被外部修改，清除该块的记录
+        XLOGE("XDiskCache read %s block %lld failed!", e->url.c_str(), index);
+        e->marks[index] = 0;
+        e->bytes -= n;
+        bytes -= n;
+        return -1;
+    }
+    e->lastUse = time(0);
+    return n;
+}
+
+bool XDiskCache::Write(XDiskEntry *e, long long index, const unsigned char *buf, int size)
+{
+    if(!e) return false;
+    std::unique_lock<std::mutex> lock(mux);
+    if(index < 0 || index >= (long long)e->marks.size() || e->marks[index]) return false;
+    //只缓存完整的块
+    if(size != BlockBytes(e, index)) return false;
+    if(!Evict(size)) return false;
+    //先占用空间并标记正在写入，其他线程不会重复写入或读取该块
+    e->marks[index] = 2;
+    e->bytes += size;
+    bytes += size;
+    int fd = e->fd;
+    int gen = e->generation;
+    lock.unlock();
+
+    bool re = pwrite(fd, buf, size, index * e->blockSize) == size;
+
+    lock.lock();
+    //写入期间资源被清空，占用的空间已随清空释放
+    if(gen != e->generation) return false;
+    if(!re)
+    {
+        XLOGE("XDiskCache write %s block %lld failed!", e->url.c_str(), index);
+        e->marks[index] = 0;
+        e->bytes -= size;
+        bytes -= size;
+        return false;
+    }
+    e->marks[index] = 1;
+    if(++e->dirty >= SAVE_BLOCKS)
+        Save(e);
+    return true;
+}
+
+XDiskCacheStats XDiskCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mux);
+    XDiskCacheStats stats;
+    stats.entries = (int)entries.size();
+    stats.bytes = bytes;
+    stats.maxBytes = maxBytes;
+    stats.evicts = evicts;
+    return stats;
+}
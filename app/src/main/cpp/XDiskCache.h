@@ -0,0 +1,128 @@
+#ifndef XPLAY_XDISKCACHE_H
+#define XPLAY_XDISKCACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+//磁盘缓存中的一个资源，对应一个url
+//数据文件为稀疏文件，块写入对应偏移，索引文件记录已缓存的块
+struct XDiskEntry
+{
+    std::string key;
+    std::string url;
+    //文件路径，不含扩展名
+    std::string path;
+    int blockSize = 0;
+    //资源总大小，未知为-1
+    long long size = -1;
+    //资源开头数据的哈希，与大小一起判断源是否变化
+    unsigned long long fingerprint = 0;
+    //每块的状态 0未缓存 1已缓存 2正在写入
+    std::vector<unsigned char> marks;
+    //已缓存的字节数
+    long long bytes = 0;
+    //最近使用时间（秒），用于跨资源LRU淘汰
+    long long lastUse = 0;
+    //打开的数量，打开中的资源不淘汰
+    int refs = 0;
+    int fd = -1;
+    //未保存到索引的块数
+    int dirty = 0;
+    //清空缓存时增加，锁外读写完成后据此判断数据是否还有效
+    int generation = 0;
+};
+
+struct XDiskCacheStats
+{
+    int entries = 0;
+    long long bytes = 0;
+    long long maxBytes = 0;
+    //淘汰的资源数
+    long long evicts = 0;
+};
+
+//HTTP点播的磁盘缓存（线程安全），再次打开或seek到已下载的范围时从本地读取
+//总大小超出上限时淘汰最久未使用的资源
+class XDiskCache
+{
+public:
+    static XDiskCache *Get()
+    {
+        static XDiskCache cache;
+        return &cache;
+    }
+
+    //缓存目录，不存在时创建并加载已有的索引，为空关闭磁盘缓存
+    //有资源打开时不能更换
+    bool SetDir(const char *dir);
+
+    //总大小上限（字节），超出的立即淘汰
+    void SetMaxBytes(long long bytes);
+
+    bool IsEnabled();
+
+    //打开url的缓存，块大小与记录不同时丢弃旧数据，失败返回空
+    //返回的指针在Close前有效
+    XDiskEntry *Open(const char *url, int blockSize);
+
+    //关闭并保存索引
+    void Close(XDiskEntry *e);
+
+    //打开源后校验大小和开头数据的哈希（FINGERPRINT_BYTES字节），与记录不同（源已变化）时清空该资源的缓存
+    //有记录且不同返回false，调用者要丢弃之前从缓存读出的数据
+    bool Validate(XDiskEntry *e, long long size, unsigned long long fingerprint);
+
+    //记录的资源大小，新资源为-1
+    long long GetSize(XDiskEntry *e);
+
+    //读取缓存的块，返回字节数，不在缓存返回-1
+    //文件读写在锁外进行，不阻塞其他资源
+    int Read(XDiskEntry *e, long long index, unsigned char *buf);
+
+    //写入一块（最后一块可不足blockSize），空间不足以淘汰其他资源，或其他线程正在写入该块时不写入
+    bool Write(XDiskEntry *e, long long index, const unsigned char *buf, int size);
+
+    XDiskCacheStats GetStats();
+
+    //url的64位FNV-1a哈希，作为缓存文件名
+    static std::string UrlKey(const char *url);
+
+    //数据的64位FNV-1a哈希
+    static unsigned long long Hash(const unsigned char *data, int size);
+
+    //校验源时取开头的字节数
+    static const int FINGERPRINT_BYTES = 4096;
+
+protected:
+    XDiskCache(){}
+
+    //块的实际字节数
+    long long BlockBytes(XDiskEntry *e, long long index);
+
+    //加载索引，数据文件不存在或索引损坏返回false
+    bool Load(const std::string &key);
+
+    //保存索引，先写临时文件再改名
+    void Save(XDiskEntry *e);
+
+    //清空资源的缓存数据
+    void Reset(XDiskEntry *e);
+
+    //删除资源的文件和记录
+    void Remove(XDiskEntry *e);
+
+    //淘汰未打开的资源，直到可以再写入need字节
+    bool Evict(long long need);
+
+    std::string dir;
+    long long maxBytes = 512LL * 1024 * 1024;
+    long long bytes = 0;
+    long long evicts = 0;
+    std::map<std::string, XDiskEntry *> entries;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XDISKCACHE_H
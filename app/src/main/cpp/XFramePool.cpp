@@ -0,0 +1,20 @@
+#include "XFramePool.h"
+extern "C"{
+#include <libavutil/frame.h>
+}
+
+AVFrame *XFrameTraits::New()
+{
+    return av_frame_alloc();
+}
+
+void XFrameTraits::Reset(AVFrame *frame)
+{
+    //释放数据引用，结构体保留复用
+    av_frame_unref(frame);
+}
+
+void XFrameTraits::Delete(AVFrame **frame)
+{
+    av_frame_free(frame);
+}
@@ -0,0 +1,21 @@
+#ifndef XPLAY_XFRAMEPOOL_H
+#define XPLAY_XFRAMEPOOL_H
+
+#include "XObjectPool.h"
+
+struct AVFrame;
+
+//AVFrame的分配、清理和释放
+struct XFrameTraits
+{
+    enum { MAX_IDLE = 32 };
+    static AVFrame *New();
+    static void Reset(AVFrame *frame);
+    static void Delete(AVFrame **frame);
+};
+
+//AVFrame对象池（线程安全），解码取出，XData::Drop归还
+typedef XObjectPool<AVFrame, XFrameTraits> XFramePool;
+
+
+#endif //XPLAY_XFRAMEPOOL_H
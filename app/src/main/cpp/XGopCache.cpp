@@ -0,0 +1,233 @@
+#include "XGopCache.h"
+#include "XClock.h"
+#include <algorithm>
+
+void XGopCache::SetMaxBytes(long long bytes)
+{
+    mux.lock();
+    maxBytes = bytes;
+    if(maxBytes <= 0)
+    {
+        gops.clear();
+        cur = 0;
+        this->bytes = 0;
+    }
+    else
+    {
+        Evict();
+    }
+    mux.unlock();
+}
+
+void XGopCache::Add(XData frame)
+{
+    if(!frame.data) return;
+    mux.lock();
+    if(maxBytes <= 0)
+    {
+        mux.unlock();
+        return;
+    }
+    if(frame.isKey)
+    {
+        //连续解码到下一个关键帧，上一个GOP完整
+        if(cur)
+        {
+            cur->endPts = frame.pts;
+            cur->isEnd = true;
+        }
+        //同一GOP再次解码（seek回到这里），替换旧的
+        for(auto it = gops.begin(); it != gops.end(); ++it)
+        {
+            if(it->keyPts == frame.pts)
+            {
+                bytes -= it->bytes;
+                gops.erase(it);
+                break;
+            }
+        }
+        gops.push_back(XGop());
+        cur = &gops.back();
+        cur->keyPts = frame.pts;
+        timeBase = frame.timeBase;
+    }
+    else if(!cur || (!cur->frames.empty() && frame.pts <= cur->frames.back().pts))
+    {
+        //没有开始的GOP，或时间戳不连续
+        mux.unlock();
+        return;
+    }
+
+    cur->frames.push_back(frame);
+    cur->bytes += frame.size;
+    cur->lastUse = ++useCount;
+    bytes += frame.size;
+    Evict();
+
+    //单个GOP超过内存上限，停止追加，已缓存的部分仍可用
+    if(cur && cur->bytes > maxBytes)
+    {
+        bytes -= cur->frames.back().size;
+        cur->bytes -= cur->frames.back().size;
+        cur->frames.pop_back();
+        cur = 0;
+    }
+    mux.unlock();
+}
+
+void XGopCache::Break()
+{
+    mux.lock();
+    cur = 0;
+    mux.unlock();
+}
+
+void XGopCache::Evict()
+{
+    while(bytes > maxBytes)
+    {
+        auto old = gops.end();
+        for(auto it = gops.begin(); it != gops.end(); ++it)
+        {
+            if(&*it == cur) continue;
+            if(old == gops.end() || it->lastUse < old->lastUse)
+                old = it;
+        }
+        if(old == gops.end()) return;
+        bytes -= old->bytes;
+        gops.erase(old);
+    }
+}
+
+XGopCache::XGop *XGopCache::Cover(long long pts)
+{
+    for(XGop &g : gops)
+    {
+        if(g.frames.empty() || pts < g.keyPts) continue;
+        if(pts <= g.frames.back().pts || (g.isEnd && pts < g.endPts))
+            return &g;
+    }
+    return 0;
+}
+
+bool XGopCache::FindPts(long long p, XData &frame)
+{
+    XGop *g = Cover(p);
+    if(!g)
+    {
+        misses++;
+        return false;
+    }
+    //第一个大于p的前一帧
+    auto it = std::upper_bound(g->frames.begin(), g->frames.end(), p,
+                               [](long long v, const XData &d) { return v < d.pts; });
+    if(it == g->frames.begin())
+    {
+        misses++;
+        return false;
+    }
+    frame = *(it - 1);
+    g->lastUse = ++useCount;
+    hits++;
+    return true;
+}
+
+bool XGopCache::FindFromPts(long long p, XData &frame)
+{
+    XGop *g = Cover(p);
+    if(!g)
+    {
+        misses++;
+        return false;
+    }
+    auto it = std::lower_bound(g->frames.begin(), g->frames.end(), p,
+                               [](const XData &d, long long v) { return d.pts < v; });
+    if(it == g->frames.end())
+    {
+        //跨到下一个GOP的关键帧
+        XGop *n = g->isEnd ? Cover(g->endPts) : 0;
+        if(!n || n->keyPts != g->endPts)
+        {
+            misses++;
+            return false;
+        }
+        g = n;
+        it = n->frames.begin();
+    }
+    frame = *it;
+    g->lastUse = ++useCount;
+    hits++;
+    return true;
+}
+
+bool XGopCache::Find(double ms, XData &frame)
+{
+    mux.lock();
+    bool re = !gops.empty() && FindFromPts(XMsToPts(ms, timeBase), frame);
+    mux.unlock();
+    return re;
+}
+
+bool XGopCache::Prev(long long pts, XData &frame)
+{
+    mux.lock();
+    bool re = FindPts(pts - 1, frame);
+    mux.unlock();
+    return re;
+}
+
+bool XGopCache::Next(long long pts, XData &frame)
+{
+    mux.lock();
+    XGop *g = Cover(pts);
+    bool re = false;
+    if(g)
+    {
+        auto it = std::upper_bound(g->frames.begin(), g->frames.end(), pts,
+                                   [](long long v, const XData &d) { return v < d.pts; });
+        if(it != g->frames.end())
+        {
+            frame = *it;
+            g->lastUse = ++useCount;
+            re = true;
+        }
+        else if(g->isEnd)
+        {
+            //跨到下一个GOP的关键帧
+            XGop *n = Cover(g->endPts);
+            if(n && n->keyPts == g->endPts)
+            {
+                frame = n->frames.front();
+                n->lastUse = ++useCount;
+                re = true;
+            }
+        }
+    }
+    if(re) hits++;
+    else misses++;
+    mux.unlock();
+    return re;
+}
+
+void XGopCache::Clear()
+{
+    mux.lock();
+    gops.clear();
+    cur = 0;
+    bytes = 0;
+    mux.unlock();
+}
+
+XGopCacheStats XGopCache::GetStats()
+{
+    XGopCacheStats stats;
+    mux.lock();
+    stats.gops = (int)gops.size();
+    for(XGop &g : gops)
+        stats.frames += (int)g.frames.size();
+    stats.bytes = bytes;
+    stats.hits = hits;
+    stats.misses = misses;
+    mux.unlock();
+    return stats;
+}
@@ -0,0 +1,85 @@
+#ifndef XPLAY_XGOPCACHE_H
+#define XPLAY_XGOPCACHE_H
+
+#include "XData.h"
+#include <vector>
+#include <list>
+#include <mutex>
+
+//GOP缓存统计
+struct XGopCacheStats
+{
+    int gops = 0;
+    int frames = 0;
+    long long bytes = 0;
+    //查找命中与未命中次数
+    long long hits = 0;
+    long long misses = 0;
+};
+
+//最近解码的GOP缓存（线程安全），按关键帧pts区分，超过内存上限时淘汰最久未使用的GOP
+//用于后退单帧和短距离拖动，命中时不需要seek和解码
+class XGopCache
+{
+public:
+    //内存上限（字节），<=0 不缓存
+    void SetMaxBytes(long long bytes);
+
+    //按解码顺序加入视频帧，关键帧开始新的GOP，之前的GOP到此结束
+    void Add(XData frame);
+
+    //解码不连续（seek、跳帧解码），之后的帧等到下一个关键帧再缓存
+    void Break();
+
+    //精确跳转到ms时刻显示的帧（pts不小于该时刻的第一帧，与跳转解码到目标的规则相同）
+    //所在GOP已缓存返回true，该时刻在GOP最后一帧之后时取下一个GOP的关键帧
+    bool Find(double ms, XData &frame);
+
+    //pts之前的一帧，可以跨到相邻的上一个GOP
+    bool Prev(long long pts, XData &frame);
+
+    //pts之后的一帧
+    bool Next(long long pts, XData &frame);
+
+    void Clear();
+
+    XGopCacheStats GetStats();
+
+protected:
+    struct XGop
+    {
+        long long keyPts = 0;
+        //下一个关键帧的pts，GOP完整结束才有效
+        long long endPts = 0;
+        bool isEnd = false;
+        std::vector<XData> frames;
+        long long bytes = 0;
+        long long lastUse = 0;
+    };
+
+    //pts所在的GOP，缓存没有覆盖返回空
+    XGop *Cover(long long pts);
+
+    //pts不大于p的最后一帧，调用者加锁
+    bool FindPts(long long p, XData &frame);
+
+    //pts不小于p的第一帧，调用者加锁
+    bool FindFromPts(long long p, XData &frame);
+
+    //淘汰最久未使用的GOP（不淘汰正在追加的GOP）
+    void Evict();
+
+    std::list<XGop> gops;
+    //正在追加的GOP
+    XGop *cur = 0;
+    XRational timeBase;
+    long long maxBytes = 64 * 1024 * 1024;
+    long long bytes = 0;
+    long long useCount = 0;
+    long long hits = 0;
+    long long misses = 0;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XGOPCACHE_H
@@ -0,0 +1,68 @@
+#include "XKeyIndex.h"
+#include <algorithm>
+
+static bool PtsLess(const XKeyFrame &k, long long pts)
+{
+    return k.pts < pts;
+}
+
+void XKeyIndex::Clear()
+{
+    mux.lock();
+    keys.clear();
+    isFull = false;
+    mux.unlock();
+}
+
+void XKeyIndex::Add(long long pts, long long pos)
+{
+    XKeyFrame key;
+    key.pts = pts;
+    key.pos = pos;
+    mux.lock();
+    //顺序读取，直接追加
+    if(keys.empty() || keys.back().pts < pts)
+    {
+        keys.push_back(key);
+        mux.unlock();
+        return;
+    }
+    //seek之后读到已有的部分，二分查找插入位置
+    auto it = std::lower_bound(keys.begin(), keys.end(), pts, PtsLess);
+    if(it == keys.end() || it->pts != pts)
+        keys.insert(it, key);
+    mux.unlock();
+}
+
+bool XKeyIndex::Find(long long pts, XKeyFrame &key)
+{
+    mux.lock();
+    //第一个大于pts的前一个
+    auto it = std::upper_bound(keys.begin(), keys.end(), pts,
+                               [](long long p, const XKeyFrame &k) { return p < k.pts; });
+    if(it == keys.begin())
+    {
+        mux.unlock();
+        return false;
+    }
+    key = *(it - 1);
+    mux.unlock();
+    return true;
+}
+
+int XKeyIndex::Size()
+{
+    mux.lock();
+    int re = (int)keys.size();
+    mux.unlock();
+    return re;
+}
+
+bool XKeyIndex::LastPts(long long &pts)
+{
+    mux.lock();
+    bool re = !keys.empty();
+    if(re) pts = keys.back().pts;
+    mux.unlock();
+    return re;
+}
@@ -0,0 +1,42 @@
+#ifndef XPLAY_XKEYINDEX_H
+#define XPLAY_XKEYINDEX_H
+
+#include <vector>
+#include <mutex>
+
+//关键帧索引项，时间戳为流时间基
+struct XKeyFrame
+{
+    long long pts = 0;
+    //在文件中的字节位置，未知为-1，容器没有索引时按字节位置跳转
+    long long pos = -1;
+};
+
+//关键帧索引（线程安全），按pts有序
+//打开时从容器索引建立，读取时补充容器没有索引的部分
+class XKeyIndex
+{
+public:
+    void Clear();
+
+    //添加关键帧，已存在则忽略；按顺序读取时追加到末尾
+    void Add(long long pts, long long pos);
+
+    //pts之前（含）最近的关键帧，没有返回false
+    bool Find(long long pts, XKeyFrame &key);
+
+    int Size();
+
+    //索引中最大的pts，为空返回false
+    bool LastPts(long long &pts);
+
+    //索引来自容器，覆盖整个文件
+    bool isFull = false;
+
+protected:
+    std::vector<XKeyFrame> keys;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XKEYINDEX_H
@@ -14,9 +14,11 @@ class XLog {
 #define XLOGI(...) __android_log_print(ANDROID_LOG_INFO,"XPlay",__VA_ARGS__)
 #define XLOGE(...) __android_log_print(ANDROID_LOG_ERROR,"XPlay",__VA_ARGS__)
 #else
-#define XLOGD(...) printf("XPlay",__VA_ARGS__)
-#define XLOGI(...) printf("XPlay",__VA_ARGS__)
-#define XLOGE(...) printf("XPlay",__VA_ARGS__)
+//主机上编译单元测试时输出到标准输出
+#include <cstdio>
+#define XLOGD(...) (printf("XPlay: "), printf(__VA_ARGS__), printf("\n"))
+#define XLOGI(...) (printf("XPlay: "), printf(__VA_ARGS__), printf("\n"))
+#define XLOGE(...) (fprintf(stderr, "XPlay: "), fprintf(stderr, __VA_ARGS__), fprintf(stderr, "\n"))
 
 #endif
 
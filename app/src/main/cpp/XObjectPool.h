@@ -0,0 +1,88 @@
+#ifndef XPLAY_XOBJECTPOOL_H
+#define XPLAY_XOBJECTPOOL_H
+
+#include <vector>
+#include <mutex>
+
+//对象池统计，用于确认稳定播放时不再分配
+struct XPoolStats
+{
+    //池为空时新分配的次数
+    long long allocs = 0;
+    //从池中复用次数
+    long long reuses = 0;
+    //池满后释放的次数
+    long long frees = 0;
+    //当前池中空闲数量
+    int idle = 0;
+};
+
+//对象池（线程安全），一个线程取出，其他线程用完归还
+//Traits提供 static T *New()、static void Reset(T *)（清理引用的数据，结构体保留）、
+//static void Delete(T **)，以及池中最多保留的空闲数量 MAX_IDLE
+template <class T, class Traits>
+class XObjectPool
+{
+public:
+    static XObjectPool *Get()
+    {
+        static XObjectPool pool;
+        return &pool;
+    }
+
+    //取出一个空对象，池为空时分配
+    T *Alloc()
+    {
+        mux.lock();
+        if (!idles.empty())
+        {
+            T *p = idles.back();
+            idles.pop_back();
+            stats.reuses++;
+            mux.unlock();
+            return p;
+        }
+        stats.allocs++;
+        mux.unlock();
+        return Traits::New();
+    }
+
+    //归还对象，清理引用的数据，池满则释放
+    void Free(T **p)
+    {
+        if (!p || !*p) return;
+        Traits::Reset(*p);
+        mux.lock();
+        if ((int)idles.size() < maxIdle)
+        {
+            idles.push_back(*p);
+            *p = 0;
+            mux.unlock();
+            return;
+        }
+        stats.frees++;
+        mux.unlock();
+        Traits::Delete(p);
+    }
+
+    XPoolStats GetStats()
+    {
+        mux.lock();
+        XPoolStats re = stats;
+        re.idle = (int)idles.size();
+        mux.unlock();
+        return re;
+    }
+
+    //池中最多保留的空闲数量
+    int maxIdle = Traits::MAX_IDLE;
+protected:
+    //进程退出前一直存在，其他静态对象析构时还会归还
+    XObjectPool() {}
+    std::vector<T *> idles;
+    XPoolStats stats;
+    std::mutex mux;
+};
+
+
+#endif //XPLAY_XOBJECTPOOL_H
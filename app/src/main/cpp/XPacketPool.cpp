@@ -0,0 +1,20 @@
+#include "XPacketPool.h"
+extern "C"{
+#include <libavcodec/avcodec.h>
+}
+
+AVPacket *XPacketTraits::New()
+{
+    return av_packet_alloc();
+}
+
+void XPacketTraits::Reset(AVPacket *pkt)
+{
+    //释放数据引用，结构体保留复用
+    av_packet_unref(pkt);
+}
+
+void XPacketTraits::Delete(AVPacket **pkt)
+{
+    av_packet_free(pkt);
+}
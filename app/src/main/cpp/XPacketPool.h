@@ -0,0 +1,21 @@
+#ifndef XPLAY_XPACKETPOOL_H
+#define XPLAY_XPACKETPOOL_H
+
+#include "XObjectPool.h"
+
+struct AVPacket;
+
+//AVPacket的分配、清理和释放
+struct XPacketTraits
+{
+    enum { MAX_IDLE = 512 };
+    static AVPacket *New();
+    static void Reset(AVPacket *pkt);
+    static void Delete(AVPacket **pkt);
+};
+
+//AVPacket对象池（线程安全），解封装取出，XData::Drop归还
+typedef XObjectPool<AVPacket, XPacketTraits> XPacketPool;
+
+
+#endif //XPLAY_XPACKETPOOL_H
@@ -1,7 +1,7 @@
 #ifndef XPLAY_XPARAMETER_H
 #define XPLAY_XPARAMETER_H
 
-
+#include "XData.h"
 
 struct AVCodecParameters;
 class XParameter
@@ -10,6 +10,8 @@ public:
     AVCodecParameters *para = 0;
     int channels = 2;
     int sample_rate = 44100;
+    //流的时间基，数据包和解码后帧的pts都使用该时间基
+    XRational timeBase;
 };
 
 
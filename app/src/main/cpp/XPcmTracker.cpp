@@ -0,0 +1,73 @@
+#include "XPcmTracker.h"
+
+void XPcmTracker::Reset(int sampleRate, int channels, int bytesPerSample, int maxBuffers)
+{
+    entries.assign(maxBuffers > 0 ? maxBuffers : 1, Entry());
+    head = 0;
+    count = 0;
+    queuedBytes = 0;
+    played = 0;
+    bytesPerMs = (double)sampleRate * channels * bytesPerSample / 1000.0;
+}
+
+bool XPcmTracker::Push(double ms, int bytes)
+{
+    if(count >= (int)entries.size()) return false;
+    Entry &e = entries[(head + count) % entries.size()];
+    e.ms = ms;
+    e.bytes = bytes;
+    count++;
+    queuedBytes += bytes;
+    return true;
+}
+
+bool XPcmTracker::Enqueue(const unsigned char *data, int size, double ms)
+{
+    if(!sink || count >= (int)entries.size()) return false;
+    if(!sink->Enqueue(data, size)) return false;
+    return Push(ms, size);
+}
+
+void XPcmTracker::SyncSink(int fallbackCount)
+{
+    int queued = sink ? sink->QueuedCount() : -1;
+    Sync(queued >= 0 ? queued : fallbackCount);
+}
+
+void XPcmTracker::Sync(int queuedCount)
+{
+    if(queuedCount < 0) queuedCount = 0;
+    while(count > queuedCount)
+    {
+        queuedBytes -= entries[head].bytes;
+        head = (head + 1) % entries.size();
+        count--;
+        played++;
+    }
+}
+
+double XPcmTracker::QueuedMs()
+{
+    if(bytesPerMs <= 0) return 0;
+    return queuedBytes / bytesPerMs;
+}
+
+bool XPcmTracker::PlayingMs(double &ms)
+{
+    //队首是静音数据时，取之后第一个有时间的缓冲，减去前面静音的时长
+    int silenceBytes = 0;
+    for(int i = 0; i < count; i++)
+    {
+        const Entry &e = entries[(head + i) % entries.size()];
+        if(e.ms < 0)
+        {
+            silenceBytes += e.bytes;
+            continue;
+        }
+        ms = e.ms;
+        if(bytesPerMs > 0)
+            ms -= silenceBytes / bytesPerMs;
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef XPLAY_XPCMTRACKER_H
+#define XPLAY_XPCMTRACKER_H
+
+#include <vector>
+
+//音频设备的缓冲队列（如OpenSL ES的SLAndroidSimpleBufferQueue），
+//主机单元测试用假设备代替
+class XPcmSink
+{
+public:
+    //入队一个缓冲，设备接收前调用者保持数据有效，失败返回false
+    virtual bool Enqueue(const unsigned char *data, int size) = 0;
+
+    //设备队列中还未播放完的缓冲数（包括正在播放的），无法获取返回-1
+    virtual int QueuedCount() = 0;
+
+    virtual ~XPcmSink() {}
+};
+
+//跟踪已送入音频设备队列的PCM缓冲，计算还未播放的时长和正在播放的位置
+//只做计算，设备通过XPcmSink访问，不依赖OpenSL（非线程安全，由调用者加锁）
+class XPcmTracker
+{
+public:
+    //音频设备，Enqueue和SyncSink使用
+    XPcmSink *sink = 0;
+
+    //设置输出格式和设备队列容量，清空记录
+    void Reset(int sampleRate, int channels, int bytesPerSample, int maxBuffers);
+
+    //记录一个入队的缓冲，ms为缓冲的时间（毫秒），< 0 表示静音等无时间的数据
+    bool Push(double ms, int bytes);
+
+    //送入设备队列并记录，记录已满或设备拒绝返回false
+    bool Enqueue(const unsigned char *data, int size, double ms);
+
+    //按设备报告的队列中缓冲数同步，移除已播放完的缓冲
+    void Sync(int queuedCount);
+
+    //向设备查询队列中的缓冲数并同步，设备无法报告时按fallbackCount同步
+    void SyncSink(int fallbackCount);
+
+    //队列中还未播放的时长（毫秒），在缓冲播放完成的回调中调用时就是准确的剩余时长
+    double QueuedMs();
+
+    //正在播放的缓冲的时间（毫秒，队首），队首为静音时按静音时长推算，没有则返回false
+    bool PlayingMs(double &ms);
+
+    int Count() { return count; }
+
+    //已播放完的缓冲总数
+    long long played = 0;
+
+protected:
+    struct Entry
+    {
+        double ms;
+        int bytes;
+    };
+    std::vector<Entry> entries;
+    int head = 0;
+    int count = 0;
+    long long queuedBytes = 0;
+    double bytesPerMs = 0;
+};
+
+
+#endif //XPLAY_XPCMTRACKER_H
@@ -0,0 +1,204 @@
+#ifndef XPLAY_XQUEUE_H
+#define XPLAY_XQUEUE_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "XRingBuffer.h"
+
+//有界阻塞队列
+//数据存放在单生产者单消费者的无锁环形缓冲中，读写两端都不加锁
+//写入端和读取端各属于一个线程（生产线程、消费线程），同一端不能被两个线程同时使用；
+//其他线程（如跳转清理、单步取帧）只能在该端所属线程确认暂停（XThread::SetPause返回true）
+//或已停止之后，才可以调用该端的TryPush/TryPop，恢复之前不能再访问
+//只有队列满（生产者）或空（消费者）需要等待时才进入条件变量，
+//对端仅在有线程等待时才加锁唤醒
+//除数量上限外，还可以按权重（如字节数）限制
+//Close后所有等待立即返回，用于线程退出
+template <class T>
+class XQueue
+{
+public:
+    explicit XQueue(int max = 100) : ring(max), maxSize(max) {}
+
+    //设置最大容量，只能在队列为空且无读写时调用
+    void SetMax(int max)
+    {
+        if (max > ring.Capacity())
+            ring.Reset(max);
+        maxSize = max;
+    }
+
+    //设置最大总权重，<=0 不限制；队列非空且总权重达到上限视为满
+    void SetMaxWeight(int max)
+    {
+        maxWeight = max;
+    }
+
+    //生产者 压入数据，weight为数据权重，队列满则阻塞，timeoutMs < 0 一直等待
+    //超时或队列关闭返回false（数据由调用者清理）
+    bool Push(const T &v, int weight = 0, int timeoutMs = -1)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!isClose)
+        {
+            if (TryPush(v, weight)) return true;
+            std::unique_lock<std::mutex> lock(mux);
+            pushWaiting++;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool isTimeout = false;
+            if (!isClose && IsFull())
+            {
+                if (timeoutMs < 0)
+                    notFull.wait(lock);
+                else
+                    isTimeout = notFull.wait_until(lock, end) == std::cv_status::timeout;
+            }
+            pushWaiting--;
+            if (isTimeout) return false;
+        }
+        return false;
+    }
+
+    //生产者 非阻塞压入，队列满或关闭返回false
+    bool TryPush(const T &v, int weight = 0)
+    {
+        if (isClose || IsFull()) return false;
+        totalWeight += weight;
+        if (!ring.TryPush(Item{v, weight}))
+        {
+            totalWeight -= weight;
+            return false;
+        }
+        Wake(popWaiting, notEmpty);
+        return true;
+    }
+
+    //消费者 取出数据，队列空则阻塞，timeoutMs < 0 一直等待
+    //超时、被Wake唤醒或队列关闭返回false
+    bool Pop(T &v, int timeoutMs = -1)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!isClose)
+        {
+            if (TryPop(v)) return true;
+            if (isWake.exchange(false)) return false;
+            std::unique_lock<std::mutex> lock(mux);
+            popWaiting++;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool isTimeout = false;
+            if (!isClose && !isWake && ring.Size() == 0)
+            {
+                if (timeoutMs < 0)
+                    notEmpty.wait(lock);
+                else
+                    isTimeout = notEmpty.wait_until(lock, end) == std::cv_status::timeout;
+            }
+            popWaiting--;
+            if (isTimeout) return TryPopLocked(v);
+        }
+        return false;
+    }
+
+    //消费者 非阻塞取出，不等待
+    bool TryPop(T &v)
+    {
+        if (!PopItem(v)) return false;
+        Wake(pushWaiting, notFull);
+        return true;
+    }
+
+    int Size()
+    {
+        return ring.Size();
+    }
+
+    //当前总权重
+    int Weight()
+    {
+        return totalWeight;
+    }
+
+    //关闭队列，唤醒所有阻塞的Push和Pop
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mux);
+        isClose = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    //重新打开队列
+    void Open()
+    {
+        isClose = false;
+        isWake = false;
+    }
+
+    //让消费者的下一次（或正在阻塞的）Pop立即返回false，用于响应暂停
+    void Wake()
+    {
+        std::lock_guard<std::mutex> lock(mux);
+        isWake = true;
+        notEmpty.notify_all();
+    }
+
+protected:
+    struct Item
+    {
+        T v;
+        int weight;
+    };
+
+    bool IsFull()
+    {
+        int size = ring.Size();
+        if (size >= maxSize) return true;
+        return maxWeight > 0 && size > 0 && totalWeight >= maxWeight;
+    }
+
+    bool PopItem(T &v)
+    {
+        Item item;
+        if (!ring.TryPop(item)) return false;
+        v = std::move(item.v);
+        totalWeight -= item.weight;
+        return true;
+    }
+
+    //对端有线程等待时才加锁唤醒，等待者计数，全部唤醒后各自重新检查
+    void Wake(std::atomic<int> &waiting, std::condition_variable &cond)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting <= 0) return;
+        std::lock_guard<std::mutex> lock(mux);
+        cond.notify_all();
+    }
+
+    //持有mux时取出（超时返回前最后检查一次）
+    bool TryPopLocked(T &v)
+    {
+        if (!PopItem(v)) return false;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pushWaiting > 0) notFull.notify_all();
+        return true;
+    }
+
+    XRingBuffer<Item> ring;
+    std::atomic<int> maxSize;
+    std::atomic<int> maxWeight{0};
+    std::atomic<int> totalWeight{0};
+    std::atomic<bool> isClose{false};
+    std::atomic<bool> isWake{false};
+    //正在等待的线程数
+    std::atomic<int> pushWaiting{0};
+    std::atomic<int> popWaiting{0};
+    //等待和唤醒
+    std::mutex mux;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+
+#endif //XPLAY_XQUEUE_H
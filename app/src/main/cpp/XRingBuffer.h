@@ -0,0 +1,76 @@
+#ifndef XPLAY_XRINGBUFFER_H
+#define XPLAY_XRINGBUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+
+//单生产者单消费者无锁环形缓冲（wait-free）
+//TryPush只能在生产者线程调用，TryPop只能在消费者线程调用
+//读写索引分别独占缓存行，避免伪共享
+template <class T>
+class XRingBuffer
+{
+public:
+    explicit XRingBuffer(int capacity = 128)
+    {
+        Reset(capacity);
+    }
+
+    //重新分配空间，容量向上取2的幂，只能在无读写时调用
+    void Reset(int capacity)
+    {
+        unsigned size = 1;
+        while ((int)size < capacity) size <<= 1;
+        buf.assign(size, T());
+        mask = size - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    //生产者 满返回false
+    bool TryPush(const T &v)
+    {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        buf[t & mask] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    //消费者 空返回false
+    bool TryPop(T &v)
+    {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        v = std::move(buf[h & mask]);
+        buf[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    int Size() const
+    {
+        return (int)(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    int Capacity() const
+    {
+        return (int)mask + 1;
+    }
+
+protected:
+    enum { CACHE_LINE = 64 };
+    char pad0[CACHE_LINE];
+    //读位置，消费者写
+    std::atomic<unsigned> head{0};
+    char pad1[CACHE_LINE - sizeof(std::atomic<unsigned>)];
+    //写位置，生产者写
+    std::atomic<unsigned> tail{0};
+    char pad2[CACHE_LINE - sizeof(std::atomic<unsigned>)];
+    std::vector<T> buf;
+    unsigned mask = 0;
+};
+
+
+#endif //XPLAY_XRINGBUFFER_H
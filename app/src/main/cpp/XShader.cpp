@@ -141,7 +141,7 @@ void XShader::Close() {
     if (vsh) glDeleteShader(vsh);
 
     // 释放纹理对象
-    for (int i = 0; i < sizeof(texts) / sizeof(unsigned int); i++) {
+    for (int i = 0; i < (int)(sizeof(texts) / sizeof(unsigned int)); i++) {
         if (texts[i]) {
             glDeleteTextures(1, &texts[i]);
         }
@@ -1,7 +1,6 @@
 #include "XThread.h"
 #include "XLog.h"
 
-#include <thread>
 using namespace std;
 void XSleep(int mis)
 {
@@ -9,53 +8,132 @@ void XSleep(int mis)
     this_thread::sleep_for(du);
 }
 
-void XThread::SetPause(bool isP)
+XThread::~XThread()
 {
-    isPause = isP;
-    //等待100毫秒
-    for(int i = 0; i < 10; i++)
+    if(!th.joinable()) return;
+    //派生类已经析构，线程还在运行是调用者的错误，至少不留下脱离的线程
+    XLOGE("XThread 析构时线程未停止!");
     {
-        if(isPausing == isP)
-        {
-            break;
-        }
-        XSleep(10);
+        lock_guard<mutex> lock(stateMux);
+        isExit = true;
+        stateCond.notify_all();
     }
+    if(th.get_id() == this_thread::get_id())
+        th.detach();
+    else
+        th.join();
+}
+
+bool XThread::SetPause(bool isP)
+{
+    {
+        lock_guard<mutex> lock(stateMux);
+        isPause = isP;
+        stateCond.notify_all();
+    }
+    Wake();
+
+    //在线程自身中调用，或线程未运行，无需等待
+    if(!isRuning || th.get_id() == this_thread::get_id())
+        return true;
+
+    //等待线程确认（线程可能阻塞在无法唤醒的调用中，如网络读取）
+    unique_lock<mutex> lock(stateMux);
+    auto isDone = [this, isP] {
+        return isPausing == isP || !isRuning || isExit;
+    };
+    if(pauseTimeoutMs < 0)
+    {
+        stateCond.wait(lock, isDone);
+        return true;
+    }
+    if(stateCond.wait_for(lock, chrono::milliseconds(pauseTimeoutMs), isDone))
+        return true;
+    XLOGE("SetPause %d 等待线程确认超时 %d ms", isP, pauseTimeoutMs);
+    return false;
+}
+
+void XThread::WaitPause()
+{
+    unique_lock<mutex> lock(stateMux);
+    isPausing = true;
+    stateCond.notify_all();
+    stateCond.wait(lock, [this] { return !isPause || isExit || isPauseWake; });
+    isPauseWake = false;
+    isPausing = false;
+    stateCond.notify_all();
+}
 
+void XThread::WakePause()
+{
+    lock_guard<mutex> lock(stateMux);
+    isPauseWake = true;
+    stateCond.notify_all();
+}
+
+void XThread::WaitTime(double ms)
+{
+    if(ms <= 0) return;
+    unique_lock<mutex> lock(stateMux);
+    stateCond.wait_for(lock, chrono::microseconds((long long)(ms * 1000)), [this] {
+        return isPause || isExit;
+    });
+}
+
+void XThread::SetRuning(bool isR)
+{
+    lock_guard<mutex> lock(stateMux);
+    isRuning = isR;
+    stateCond.notify_all();
 }
+
 //启动线程
 bool XThread::Start()
 {
+    if(th.joinable())
+        Stop();
     isExit = false;
     isPause = false;
-    thread th(&XThread::ThreadMain,this);
-    th.detach();
+    isPausing = false;
+    isRuning = true;
+    th = thread(&XThread::ThreadMain,this);
     return true;
 }
 void XThread::ThreadMain()
 {
-    isRuning = true;
     XLOGI("线程函数进入");
     Main();
     XLOGI("线程函数退出");
-    isRuning = false;
+    SetRuning(false);
 }
 
 
-//通过控制isExit安全停止线程（不一定成功）
+//通知线程退出，并等待线程结束
 void XThread::Stop()
-{XLOGI("Stop 停止线程begin!");
-    isExit = true;
-    for(int i = 0; i < 200; i++)
+{
+    XLOGI("Stop 停止线程begin!");
     {
-        if(!isRuning)
-        {
-            XLOGI("Stop 停止线程成功!");
+        lock_guard<mutex> lock(stateMux);
+        isExit = true;
+        stateCond.notify_all();
+    }
+    Wake();
 
-            return;
-        }
-        XSleep(1);
+    if(th.joinable())
+    {
+        //线程内部调用Stop不能join自身
+        if(th.get_id() == this_thread::get_id())
+            th.detach();
+        else
+            th.join();
+        XLOGI("Stop 停止线程成功!");
+        return;
     }
-    XLOGI("Stop 停止线程超时!");
 
+    //不由Start启动的线程，等待其退出运行
+    unique_lock<mutex> lock(stateMux);
+    if(stateCond.wait_for(lock, chrono::milliseconds(200), [this] { return !isRuning; }))
+        XLOGI("Stop 停止线程成功!");
+    else
+        XLOGI("Stop 停止线程超时!");
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #ifndef XPLAY_XTHREAD_H
 #define XPLAY_XTHREAD_H
 
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
 //sleep 毫秒
 void XSleep(int mis);
 
@@ -11,28 +16,54 @@ public:
     //启动线程
     virtual bool Start();
 
-    //通过控制isExit安全停止线程（不一定成功）
+    //通知线程退出，并等待线程结束(join)
     virtual void Stop();
 
-    virtual void SetPause(bool isP);
+    //设置暂停，并等待线程确认进入（或离开）暂停状态，最多等待pauseTimeoutMs
+    //超时（线程阻塞在无法唤醒的调用中）返回false，此时线程可能还在访问其缓冲
+    virtual bool SetPause(bool isP);
 
     virtual bool IsPause()
     {
-        isPausing = isPause;
         return isPause;
     }
 
     //入口主函数
     virtual void Main() {}
 
+    //确认暂停最多等待的毫秒数，<0 一直等待
+    int pauseTimeoutMs = 100;
+
+    //析构前必须Stop，否则在析构中通知退出并等待线程结束
+    virtual ~XThread();
+
 protected:
-    bool isExit = false;
-    bool isRuning = false;
-    bool isPause = false;
-    bool isPausing = false;
+    //线程内调用，暂停时阻塞，直到恢复、退出或WakePause
+    void WaitPause();
+
+    //让暂停中的线程从WaitPause返回一次（保持暂停），用于暂停时处理单个任务
+    void WakePause();
+
+    //线程内调用，等待ms毫秒（微秒精度），暂停或退出时提前返回
+    void WaitTime(double ms);
+
+    //唤醒阻塞在等待中的线程（如缓冲队列），使其及时响应暂停和退出
+    virtual void Wake() {}
+
+    //不由Start启动的线程（如音频回调）标记是否在运行
+    void SetRuning(bool isR);
+
+    std::atomic<bool> isExit{false};
+    std::atomic<bool> isRuning{false};
+    std::atomic<bool> isPause{false};
+    std::atomic<bool> isPausing{false};
+    std::atomic<bool> isPauseWake{false};
 private:
     void ThreadMain();
 
+    std::thread th;
+    std::mutex stateMux;
+    std::condition_variable stateCond;
 };
 
 
@@ -4,6 +4,8 @@
 
 #include "XLog.h"
 #include "IPlayerPorxy.h"
+#include "XDiskCache.h"
+#include "FFStreamInfo.h"
 extern "C"
 JNIEXPORT
 jint JNI_OnLoad(JavaVM *vm,void *res)
@@ -58,4 +60,16 @@ Java_xplay_xplay_XPlay_PlayOrPause(JNIEnv *env, jobject instance) {
 
     IPlayerPorxy::Get()->SetPause(!IPlayerPorxy::Get()->IsPause());
 
-}
\ No newline at end of file
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_xplay_xplay_MainActivity_SetCacheDir(JNIEnv *env, jobject instance, jstring dir_) {
+    const char *dir = env->GetStringUTFChars(dir_, 0);
+
+    //http点播的磁盘缓存，流信息保存在子目录
+    XDiskCache::Get()->SetDir(dir);
+    FFStreamInfo::Get()->SetDir((std::string(dir) + "/info").c_str());
+
+    env->ReleaseStringUTFChars(dir_, dir);
+}
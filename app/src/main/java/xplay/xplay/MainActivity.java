@@ -36,6 +36,9 @@ public class MainActivity extends AppCompatActivity implements Runnable,SeekBar.
         setRequestedOrientation( ActivityInfo.SCREEN_ORIENTATION_LANDSCAPE );
 
 
+        //缓存目录，保存http点播的数据和流信息
+        SetCacheDir( getCacheDir().getAbsolutePath() + "/xplay" );
+
         setContentView( R.layout.activity_main );
         bt = findViewById( R.id.open_button );
         seek = findViewById( R.id.aplayseek );
@@ -74,6 +77,7 @@ public class MainActivity extends AppCompatActivity implements Runnable,SeekBar.
     }
     public native double PlayPos();
     public native void Seek(double pos);
+    public native void SetCacheDir(String dir);
 
     @Override
     public void onProgressChanged(SeekBar seekBar, int i, boolean b) {
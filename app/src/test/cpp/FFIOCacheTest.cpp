@@ -0,0 +1,227 @@
+//FFIOCache：按块读取的内容正确、LRU淘汰后重新从源读取、顺序读取时后台预读、解封装读取优先于预读
+#include "XTest.h"
+#include "FFIOCache.h"
+#include "XThread.h"
+#include <algorithm>
+#include <vector>
+#include <mutex>
+extern "C"{
+#include <libavformat/avformat.h>
+}
+
+static const int BS = 4096;
+//最后一块不满
+static const long long SIZE = 64LL * BS + 100;
+
+static unsigned char Byte(long long i)
+{
+    return (unsigned char)(i * 13 % 251);
+}
+
+//内存中的源，记录每次从源读取的块号
+class TestCache : public FFIOCache
+{
+public:
+    using FFIOCache::Read;
+    using FFIOCache::Seek;
+    using FFIOCache::Fetch;
+    using FFIOCache::demandCount;
+
+    //每次读取源的延迟，模拟慢速网络
+    int delayMs = 0;
+
+    TestCache()
+    {
+        blockSize = BS;
+    }
+
+    ~TestCache()
+    {
+        Close();
+    }
+
+    std::vector<long long> Fetched()
+    {
+        std::lock_guard<std::mutex> lock(fetchMux);
+        return fetched;
+    }
+
+    int FetchCount(long long index)
+    {
+        std::vector<long long> f = Fetched();
+        return (int)std::count(f.begin(), f.end(), index);
+    }
+
+    bool HasBlock(long long index)
+    {
+        std::lock_guard<std::mutex> lock(mux);
+        return blocks.find(index) != blocks.end();
+    }
+
+    int BlockCount()
+    {
+        std::lock_guard<std::mutex> lock(mux);
+        return (int)blocks.size();
+    }
+
+    //等待预读线程读取到该块，超时返回false
+    bool WaitBlock(long long index)
+    {
+        for(int i = 0; i < 2000 && !HasBlock(index); i++)
+            XSleep(1);
+        return HasBlock(index);
+    }
+
+protected:
+    //源只在持有srcMux时读取，srcPos不需要另外加锁
+    virtual AVIOContext *SrcOpen()
+    {
+        srcPos = 0;
+        return (AVIOContext *)&srcPos;
+    }
+
+    virtual long long SrcSize(AVIOContext *s)
+    {
+        (void)s;
+        return SIZE;
+    }
+
+    virtual int SrcRead(AVIOContext *s, unsigned char *buf, int size)
+    {
+        (void)s;
+        if(delayMs > 0) XSleep(delayMs);
+        if(srcPos >= SIZE) return AVERROR_EOF;
+        int n = (int)std::min((long long)size, SIZE - srcPos);
+        for(int i = 0; i < n; i++)
+            buf[i] = Byte(srcPos + i);
+        if(srcPos % BS == 0)
+        {
+            std::lock_guard<std::mutex> lock(fetchMux);
+            fetched.push_back(srcPos / BS);
+        }
+        srcPos += n;
+        return n;
+    }
+
+    virtual bool SrcSeek(AVIOContext *s, long long offset)
+    {
+        (void)s;
+        srcPos = offset;
+        return true;
+    }
+
+    virtual void SrcClose(AVIOContext **s)
+    {
+        *s = 0;
+    }
+
+    long long srcPos = 0;
+    std::mutex fetchMux;
+    std::vector<long long> fetched;
+};
+
+//从from读取size字节并校验内容
+static void ReadCheck(TestCache &c, long long from, int size)
+{
+    XCHECK(c.Seek(from, SEEK_SET) == from);
+    std::vector<unsigned char> buf(size);
+    int got = 0;
+    while(got < size)
+    {
+        int n = c.Read(buf.data() + got, size - got);
+        XCHECK(n > 0);
+        got += n;
+    }
+    for(int i = 0; i < size; i++)
+        XCHECK(buf[i] == Byte(from + i));
+}
+
+int main()
+{
+    //1 不按块对齐地顺序读到结尾，内容正确，每块只从源读取一次
+    {
+        TestCache c;
+        c.maxBlocks = 8;
+        c.readAhead = 2;
+        XCHECK(c.Open("mem://seq"));
+        XCHECK(c.Seek(0, AVSEEK_SIZE) == SIZE);
+        std::vector<unsigned char> buf(1000);
+        long long p = 0;
+        while(true)
+        {
+            int n = c.Read(buf.data(), (int)buf.size());
+            if(n == AVERROR_EOF) break;
+            XCHECK(n > 0);
+            for(int i = 0; i < n; i++)
+                XCHECK(buf[i] == Byte(p + i));
+            p += n;
+        }
+        XCHECK(p == SIZE);
+        for(long long i = 0; i <= SIZE / BS; i++) XCHECK(c.FetchCount(i) == 1);
+        XIOStats st = c.GetStats();
+        XCHECK(st.readBytes == SIZE);
+        XCHECK(st.fetchBytes == SIZE);
+        XCHECK(st.hits > st.misses);
+
+        //2 LRU：最多保留maxBlocks块，最近读过的块命中，淘汰的块重新从源读取
+        XCHECK(c.BlockCount() <= c.maxBlocks);
+        XCHECK(c.HasBlock(SIZE / BS));
+        XCHECK(!c.HasBlock(0));
+        ReadCheck(c, SIZE - 50, 50);
+        XCHECK(c.FetchCount(SIZE / BS) == 1);
+        ReadCheck(c, 10, 100);
+        XCHECK(c.FetchCount(0) == 2);
+    }
+
+    //3 预读：读取块0后后台读取之后readAhead块，不多读，读到预读的块时命中
+    {
+        TestCache c;
+        c.readAhead = 4;
+        XCHECK(c.Open("mem://ahead"));
+        ReadCheck(c, 0, 10);
+        XCHECK(c.WaitBlock(4));
+        for(int i = 1; i <= 4; i++)
+            XCHECK(c.HasBlock(i));
+        XSleep(20);
+        XCHECK(!c.HasBlock(5));
+        long long hits = c.GetStats().hits;
+        ReadCheck(c, 2LL * BS + 5, 100);
+        XCHECK(c.GetStats().hits == hits + 1);
+        XCHECK(c.FetchCount(2) == 1);
+    }
+
+    //4 慢速源上预读进行中跳转，解码器等待的块最多排在预读正在读取的一块之后
+    {
+        TestCache c;
+        c.readAhead = 8;
+        c.maxBlocks = 32;
+        c.delayMs = 20;
+        XCHECK(c.Open("mem://demand"));
+        ReadCheck(c, 0, 10);
+        XSleep(5);
+        ReadCheck(c, 40LL * BS, 10);
+        std::vector<long long> f = c.Fetched();
+        auto it = std::find(f.begin(), f.end(), 40);
+        XCHECK(it != f.end());
+        for(auto i = f.begin(); i != it; ++i)
+            XCHECK(*i <= 1);
+    }
+
+    //5 有解封装读取在等待源时，预读不读取，解封装读取照常
+    {
+        TestCache c;
+        c.readAhead = 0;
+        XCHECK(c.Open("mem://yield"));
+        c.demandCount++;
+        XCHECK(!c.Fetch(10, true));
+        XCHECK(c.FetchCount(10) == 0);
+        XCHECK(c.Fetch(10, false));
+        XCHECK(c.FetchCount(10) == 1);
+        c.demandCount--;
+        XCHECK(c.Fetch(11, true));
+        XCHECK(c.FetchCount(11) == 1);
+    }
+
+    printf("FFIOCacheTest passed\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+//主机上没有ffmpeg库，提供被测模块用到的少数函数
+//只满足测试需要：包和帧只分配结构体，不管理数据缓冲
+extern "C"{
+#include <libavutil/mathematics.h>
+#include <libavutil/frame.h>
+#include <libavutil/mem.h>
+#include <libavcodec/avcodec.h>
+#include <libavformat/avio.h>
+}
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+int64_t av_rescale_q(int64_t a, AVRational bq, AVRational cq)
+{
+    long double v = (long double)a * bq.num * cq.den / ((long double)bq.den * cq.num);
+    return (int64_t)std::llround(v);
+}
+
+AVPacket *av_packet_alloc(void)
+{
+    return (AVPacket *)calloc(1, sizeof(AVPacket));
+}
+
+void av_packet_unref(AVPacket *pkt)
+{
+    (void)pkt;
+}
+
+void av_packet_free(AVPacket **pkt)
+{
+    if(!pkt) return;
+    free(*pkt);
+    *pkt = 0;
+}
+
+AVFrame *av_frame_alloc(void)
+{
+    return (AVFrame *)calloc(1, sizeof(AVFrame));
+}
+
+void av_frame_unref(AVFrame *frame)
+{
+    (void)frame;
+}
+
+void av_frame_free(AVFrame **frame)
+{
+    if(!frame) return;
+    free(*frame);
+    *frame = 0;
+}
+
+void *av_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void av_free(void *ptr)
+{
+    free(ptr);
+}
+
+void av_freep(void *ptr)
+{
+    void **p = (void **)ptr;
+    free(*p);
+    *p = 0;
+}
+
+AVIOContext *avio_alloc_context(unsigned char *buffer, int buffer_size, int write_flag, void *opaque,
+                                int (*read_packet)(void *opaque, uint8_t *buf, int buf_size),
+                                int (*write_packet)(void *opaque, uint8_t *buf, int buf_size),
+                                int64_t (*seek)(void *opaque, int64_t offset, int whence))
+{
+    AVIOContext *io = (AVIOContext *)calloc(1, sizeof(AVIOContext));
+    if(!io) return 0;
+    io->buffer = buffer;
+    io->buffer_size = buffer_size;
+    io->write_flag = write_flag;
+    io->opaque = opaque;
+    io->read_packet = read_packet;
+    io->write_packet = write_packet;
+    io->seek = seek;
+    return io;
+}
+
+void avio_context_free(AVIOContext **s)
+{
+    if(!s) return;
+    free(*s);
+    *s = 0;
+}
+
+//主机上没有网络协议，FFIOCache的测试替换了源的读取，以下只为链接
+int avio_open2(AVIOContext **s, const char *url, int flags,
+               const AVIOInterruptCB *int_cb, AVDictionary **options)
+{
+    (void)url; (void)flags; (void)int_cb; (void)options;
+    *s = 0;
+    return AVERROR(ENOSYS);
+}
+
+int avio_closep(AVIOContext **s)
+{
+    *s = 0;
+    return 0;
+}
+
+int avio_read(AVIOContext *s, unsigned char *buf, int size)
+{
+    (void)s; (void)buf; (void)size;
+    return AVERROR(ENOSYS);
+}
+
+int64_t avio_seek(AVIOContext *s, int64_t offset, int whence)
+{
+    (void)s; (void)offset; (void)whence;
+    return AVERROR(ENOSYS);
+}
+
+int64_t avio_size(AVIOContext *s)
+{
+    (void)s;
+    return AVERROR(ENOSYS);
+}
+
+int av_strerror(int errnum, char *errbuf, size_t errbuf_size)
+{
+    snprintf(errbuf, errbuf_size, "error %d", errnum);
+    return 0;
+}
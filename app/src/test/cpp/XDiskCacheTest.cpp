@@ -0,0 +1,171 @@
+//XDiskCache：块写入读取、重新加载索引、源变化时清空、跨资源淘汰、多线程读写同一资源
+#include "XTest.h"
+#include "XDiskCache.h"
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const int BS = 1000;
+
+//块内容由资源和块号决定，读出后可以校验
+static void Fill(unsigned char *buf, int n, int asset, long long index)
+{
+    for(int i = 0; i < n; i++)
+        buf[i] = (unsigned char)(asset * 31 + index * 7 + i);
+}
+
+static bool Check(const unsigned char *buf, int n, int asset, long long index)
+{
+    std::vector<unsigned char> want(n);
+    Fill(want.data(), n, asset, index);
+    return memcmp(buf, want.data(), n) == 0;
+}
+
+static void WriteAll(XDiskEntry *e, int asset, int blocks, long long size)
+{
+    unsigned char buf[BS];
+    for(int i = 0; i < blocks; i++)
+    {
+        int n = (int)(size - i * BS < BS ? size - i * BS : BS);
+        Fill(buf, n, asset, i);
+        XCHECK(XDiskCache::Get()->Write(e, i, buf, n));
+    }
+}
+
+static bool Exists(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+int main()
+{
+    char tmpl[] = "/tmp/xdiskcacheXXXXXX";
+    XCHECK(mkdtemp(tmpl));
+    std::string dir = tmpl;
+    XDiskCache *cache = XDiskCache::Get();
+    XCHECK(cache->SetDir(dir.c_str()));
+    cache->SetMaxBytes(10 * BS);
+    unsigned char buf[BS];
+
+    //1 新资源：记录大小，写入完整的块，最后一块不足blockSize
+    const char *urlA = "http://test/a.mp4";
+    XDiskEntry *a = cache->Open(urlA, BS);
+    XCHECK(a);
+    XCHECK(cache->GetSize(a) == -1);
+    XCHECK(cache->Validate(a, 4500, 1));
+    XCHECK(cache->Read(a, 0, buf) == -1);
+    WriteAll(a, 1, 5, 4500);
+    //不完整的块和已缓存的块不写入
+    XCHECK(!cache->Write(a, 4, buf, 100));
+    XCHECK(!cache->Write(a, 0, buf, BS));
+    XCHECK(cache->Read(a, 2, buf) == BS && Check(buf, BS, 1, 2));
+    XCHECK(cache->Read(a, 4, buf) == 500 && Check(buf, 500, 1, 4));
+    XCHECK(cache->GetStats().bytes == 4500);
+    cache->Close(a);
+
+    //2 重新加载目录，索引和数据仍然有效
+    XCHECK(cache->SetDir(dir.c_str()));
+    XCHECK(cache->GetStats().entries == 1 && cache->GetStats().bytes == 4500);
+    a = cache->Open(urlA, BS);
+    XCHECK(cache->GetSize(a) == 4500);
+    XCHECK(cache->Validate(a, 4500, 1));
+    XCHECK(cache->Read(a, 3, buf) == BS && Check(buf, BS, 1, 3));
+
+    //3 大小相同但开头数据变化，清空全部块
+    XCHECK(!cache->Validate(a, 4500, 2));
+    XCHECK(cache->Read(a, 3, buf) == -1);
+    XCHECK(cache->GetStats().bytes == 0);
+    //大小变化同样清空
+    WriteAll(a, 1, 1, 4500);
+    XCHECK(!cache->Validate(a, 3000, 2));
+    XCHECK(cache->Read(a, 0, buf) == -1);
+    cache->Close(a);
+    //没有数据的资源关闭时删除
+    XCHECK(cache->GetStats().entries == 0);
+
+    //4 超出上限时淘汰未打开的资源，打开中的不淘汰
+    const char *urlB = "http://test/b.mp4";
+    const char *urlC = "http://test/c.mp4";
+    XDiskEntry *b = cache->Open(urlB, BS);
+    XCHECK(cache->Validate(b, 6 * BS, 3));
+    WriteAll(b, 2, 6, 6 * BS);
+    cache->Close(b);
+    XDiskEntry *c = cache->Open(urlC, BS);
+    XCHECK(cache->Validate(c, 6 * BS, 4));
+    WriteAll(c, 3, 6, 6 * BS);
+    XCHECK(cache->GetStats().evicts == 1);
+    XCHECK(!Exists(dir + "/" + XDiskCache::UrlKey(urlB) + ".data"));
+    XCHECK(cache->GetStats().bytes == 6 * BS);
+    //c打开中，b再写入超出上限时不能淘汰c，写入失败
+    b = cache->Open(urlB, BS);
+    XCHECK(cache->GetSize(b) == -1);
+    XCHECK(cache->Validate(b, 6 * BS, 3));
+    unsigned char full[BS];
+    int ok = 0;
+    for(int i = 0; i < 6; i++)
+    {
+        Fill(full, BS, 2, i);
+        if(cache->Write(b, i, full, BS)) ok++;
+    }
+    XCHECK(ok == 4);
+    cache->Close(b);
+    cache->Close(c);
+
+    //5 多个线程读写同一资源（播放器和缩略图同时打开），同时有线程清空
+    cache->SetMaxBytes(1000LL * BS);
+    long long base = cache->GetStats().bytes;
+    const char *urlD = "http://test/d.mp4";
+    XDiskEntry *d = cache->Open(urlD, BS);
+    XDiskEntry *d2 = cache->Open(urlD, BS);
+    XCHECK(d == d2);
+    XCHECK(cache->Validate(d, 100 * BS, 5));
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([t, d] {
+            unsigned char tb[BS];
+            for(int k = 0; k < 2000; k++)
+            {
+                long long index = (k * 7 + t * 13) % 100;
+                if(XDiskCache::Get()->Read(d, index, tb) == BS)
+                {
+                    XCHECK(Check(tb, BS, 4, index));
+                    continue;
+                }
+                Fill(tb, BS, 4, index);
+                XDiskCache::Get()->Write(d, index, tb, BS);
+            }
+        }));
+    }
+    threads.push_back(std::thread([d] {
+        for(int k = 0; k < 20; k++)
+        {
+            XDiskCache::Get()->Validate(d, 100 * BS, 6 + k % 2);
+            usleep(500);
+        }
+    }));
+    for(auto &t : threads) t.join();
+    //统计的字节数与已缓存的块一致
+    long long n = 0;
+    for(int i = 0; i < 100; i++)
+    {
+        if(cache->Read(d, i, buf) == BS)
+        {
+            XCHECK(Check(buf, BS, 4, i));
+            n += BS;
+        }
+    }
+    XCHECK(cache->GetStats().bytes == base + n);
+    cache->Close(d);
+    cache->Close(d2);
+
+    XCHECK(cache->SetDir(""));
+    std::string cmd = "rm -rf " + dir;
+    XCHECK(system(cmd.c_str()) == 0);
+    printf("XDiskCacheTest passed\n");
+    return 0;
+}
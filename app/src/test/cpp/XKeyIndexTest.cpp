@@ -0,0 +1,61 @@
+//XKeyIndex：顺序追加和乱序插入后有序不重复，Find取目标之前（含）最近的关键帧，LastPts和isFull
+#include "XTest.h"
+#include "XKeyIndex.h"
+
+int main()
+{
+    XKeyIndex index;
+    XKeyFrame key;
+    long long last = 0;
+
+    //1 空索引
+    XCHECK(index.Size() == 0);
+    XCHECK(!index.Find(0, key));
+    XCHECK(!index.LastPts(last));
+    XCHECK(!index.isFull);
+
+    //2 顺序读取追加，每100一个关键帧，字节位置为pts*10
+    for(long long pts = 100; pts <= 1000; pts += 100)
+        index.Add(pts, pts * 10);
+    XCHECK(index.Size() == 10);
+    XCHECK(index.LastPts(last) && last == 1000);
+
+    //目标之前没有关键帧
+    XCHECK(!index.Find(99, key));
+    //正好是关键帧
+    XCHECK(index.Find(100, key) && key.pts == 100 && key.pos == 1000);
+    XCHECK(index.Find(500, key) && key.pts == 500 && key.pos == 5000);
+    //两个关键帧之间取前一个
+    XCHECK(index.Find(599, key) && key.pts == 500);
+    XCHECK(index.Find(601, key) && key.pts == 600);
+    //最后一个之后
+    XCHECK(index.Find(100000, key) && key.pts == 1000);
+
+    //3 seek之后读到已有的部分：重复的忽略，中间缺的插入到正确位置
+    index.Add(500, 1);
+    index.Add(300, 1);
+    XCHECK(index.Size() == 10);
+    XCHECK(index.Find(500, key) && key.pos == 5000);
+    index.Add(550, 5500);
+    index.Add(50, -1);
+    XCHECK(index.Size() == 12);
+    XCHECK(index.Find(560, key) && key.pts == 550 && key.pos == 5500);
+    XCHECK(index.Find(549, key) && key.pts == 500);
+    XCHECK(index.Find(60, key) && key.pts == 50 && key.pos == -1);
+    XCHECK(index.LastPts(last) && last == 1000);
+
+    //4 负的时间戳（MP4解码时间戳可能从负数开始）
+    index.Add(-200, 0);
+    XCHECK(index.Find(-1, key) && key.pts == -200);
+    XCHECK(!index.Find(-201, key));
+
+    //5 Clear清空并重置isFull
+    index.isFull = true;
+    index.Clear();
+    XCHECK(index.Size() == 0);
+    XCHECK(!index.isFull);
+    XCHECK(!index.Find(1000, key));
+
+    printf("XKeyIndexTest passed\n");
+    return 0;
+}
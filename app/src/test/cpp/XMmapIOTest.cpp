@@ -0,0 +1,101 @@
+//FFMmapIO：顺序读取和跳转的内容正确，播放中文件被截断时改用pread读到新的结尾，不触发SIGBUS
+#include "XTest.h"
+#include "FFMmapIO.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+extern "C"{
+#include <libavformat/avformat.h>
+}
+
+static const long long SIZE = 16LL * 1024 * 1024;
+static const int CHUNK = 32 * 1024;
+
+static unsigned char Byte(long long i)
+{
+    return (unsigned char)(i * 13 % 251);
+}
+
+class TestIO : public FFMmapIO
+{
+public:
+    using FFMmapIO::Read;
+    using FFMmapIO::Seek;
+};
+
+//读取到结尾，校验内容，返回读取的字节数
+static long long ReadToEnd(TestIO &io, long long from)
+{
+    std::vector<unsigned char> buf(CHUNK);
+    long long p = from;
+    while(true)
+    {
+        int n = io.Read(buf.data(), CHUNK);
+        if(n == AVERROR_EOF) break;
+        XCHECK(n > 0);
+        for(int i = 0; i < n; i++)
+            XCHECK(buf[i] == Byte(p + i));
+        p += n;
+    }
+    return p - from;
+}
+
+int main()
+{
+    char path[] = "/tmp/xmmapioXXXXXX";
+    int fd = mkstemp(path);
+    XCHECK(fd >= 0);
+    std::vector<unsigned char> block(1024 * 1024);
+    for(long long off = 0; off < SIZE; off += (long long)block.size())
+    {
+        for(size_t i = 0; i < block.size(); i++)
+            block[i] = Byte(off + (long long)i);
+        XCHECK(write(fd, block.data(), block.size()) == (ssize_t)block.size());
+    }
+
+    //1 顺序读取，窗口随读取位置前进
+    TestIO io;
+    io.aheadBytes = 1024 * 1024;
+    XCHECK(io.Open(path));
+    XCHECK(io.Size() == SIZE);
+    XCHECK(ReadToEnd(io, 0) == SIZE);
+    XMmapStats st = io.GetStats();
+    XCHECK(st.readBytes == SIZE);
+    XCHECK(st.advises >= SIZE / io.aheadBytes);
+    XCHECK(st.preads == 0);
+
+    //2 跳转后读取
+    XCHECK(io.Seek(10 * 1024 * 1024 + 7, SEEK_SET) == 10 * 1024 * 1024 + 7);
+    XCHECK(ReadToEnd(io, 10 * 1024 * 1024 + 7) == SIZE - 10 * 1024 * 1024 - 7);
+    XCHECK(io.Seek(-100, SEEK_END) == SIZE - 100);
+    XCHECK(ReadToEnd(io, SIZE - 100) == 100);
+    XCHECK(io.Seek(0, AVSEEK_SIZE) == SIZE);
+    io.Close();
+
+    //3 读取中文件被截断到当前窗口之后，读到新的结尾结束
+    XCHECK(io.Open(path));
+    std::vector<unsigned char> buf(CHUNK);
+    long long p = 0;
+    while(p < 512 * 1024)
+    {
+        int n = io.Read(buf.data(), CHUNK);
+        XCHECK(n > 0);
+        p += n;
+    }
+    const long long CUT = 4 * 1024 * 1024 + 123;
+    XCHECK(ftruncate(fd, CUT) == 0);
+    XCHECK(ReadToEnd(io, p) == CUT - p);
+    XCHECK(io.GetStats().preads > 0);
+    XCHECK(io.Seek(0, AVSEEK_SIZE) == CUT);
+    //截断后跳转也只用pread
+    XCHECK(io.Seek(CUT - 10, SEEK_SET) == CUT - 10);
+    XCHECK(ReadToEnd(io, CUT - 10) == 10);
+    io.Close();
+
+    close(fd);
+    unlink(path);
+    printf("XMmapIOTest passed\n");
+    return 0;
+}
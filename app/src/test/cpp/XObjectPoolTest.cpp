@@ -0,0 +1,96 @@
+//对象池：跨线程取出归还，预热后稳定运行不再分配；池满时释放
+#include "XTest.h"
+#include "XObjectPool.h"
+#include "XQueue.h"
+#include <thread>
+#include <vector>
+
+//模拟AVPacket，统计存活数量
+struct FakePacket
+{
+    int size = 0;
+};
+
+static std::atomic<int> alive{0};
+
+struct FakeTraits
+{
+    enum { MAX_IDLE = 64 };
+    static FakePacket *New()
+    {
+        alive++;
+        return new FakePacket();
+    }
+    static void Reset(FakePacket *p)
+    {
+        p->size = 0;
+    }
+    static void Delete(FakePacket **p)
+    {
+        alive--;
+        delete *p;
+        *p = 0;
+    }
+};
+
+typedef XObjectPool<FakePacket, FakeTraits> FakePool;
+
+//解封装线程取出，经过队列交给解码线程使用后归还，与播放时相同
+static void Run(XQueue<FakePacket *> &q, int count)
+{
+    std::thread decoder([&q, count] {
+        for (int i = 0; i < count; i++)
+        {
+            FakePacket *p = 0;
+            XCHECK(q.Pop(p));
+            XCHECK(p->size == i + 1);
+            FakePool::Get()->Free(&p);
+            XCHECK(p == 0);
+        }
+    });
+    for (int i = 0; i < count; i++)
+    {
+        FakePacket *p = FakePool::Get()->Alloc();
+        XCHECK(p && p->size == 0);
+        p->size = i + 1;
+        XCHECK(q.Push(p));
+    }
+    decoder.join();
+}
+
+int main()
+{
+    FakePool *pool = FakePool::Get();
+    //队列最多16个在途，加上两端各持有一个
+    XQueue<FakePacket *> q(16);
+
+    //预热
+    Run(q, 10000);
+    XPoolStats warm = pool->GetStats();
+    XCHECK(warm.allocs > 0 && warm.allocs <= 16 + 2);
+    XCHECK(warm.frees == 0);
+
+    //稳定运行不再分配，全部复用
+    Run(q, 200000);
+    XPoolStats steady = pool->GetStats();
+    XCHECK(steady.allocs == warm.allocs);
+    XCHECK(steady.reuses == warm.reuses + 200000);
+    XCHECK(steady.idle == warm.allocs);
+    XCHECK(alive == warm.allocs);
+
+    //超过maxIdle归还的直接释放
+    pool->maxIdle = 4;
+    int total = steady.idle + 10;
+    std::vector<FakePacket *> ps;
+    for (int i = 0; i < total; i++)
+        ps.push_back(pool->Alloc());
+    XCHECK(pool->GetStats().allocs == steady.allocs + 10);
+    for (FakePacket *&p : ps)
+        pool->Free(&p);
+    XPoolStats over = pool->GetStats();
+    XCHECK(over.idle == 4);
+    XCHECK(alive == 4);
+    XCHECK(over.frees == total - 4);
+    printf("XObjectPoolTest passed allocs %lld reuses %lld\n", over.allocs, over.reuses);
+    return 0;
+}
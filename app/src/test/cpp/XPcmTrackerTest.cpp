@@ -0,0 +1,101 @@
+//XPcmTracker的延迟计算，假设备模拟OpenSL缓冲队列：按入队顺序播放，回调时报告队列中的缓冲数
+#include "XTest.h"
+#include "XPcmTracker.h"
+#include <cmath>
+#include <deque>
+
+class FakeSink : public XPcmSink
+{
+public:
+    int capacity = 4;
+    bool isStateOk = true;
+    std::deque<int> queue;
+
+    bool Enqueue(const unsigned char *data, int size)
+    {
+        if (!data || (int)queue.size() >= capacity) return false;
+        queue.push_back(size);
+        return true;
+    }
+
+    int QueuedCount()
+    {
+        return isStateOk ? (int)queue.size() : -1;
+    }
+
+    //队首缓冲播放完成（设备回调）
+    void Finish()
+    {
+        queue.pop_front();
+    }
+};
+
+static bool Near(double a, double b)
+{
+    return std::fabs(a - b) < 0.001;
+}
+
+int main()
+{
+    //48kHz 立体声 16位：每毫秒192字节，20ms一个缓冲
+    const int BUF = 20 * 192;
+    static unsigned char pcm[BUF];
+    static unsigned char silence[4];
+    FakeSink sink;
+    XPcmTracker tracker;
+    tracker.Reset(48000, 2, 2, 4);
+    tracker.sink = &sink;
+
+    //启动时入队静音，再入队两个有时间的缓冲
+    XCHECK(tracker.Enqueue(silence, sizeof(silence), -1));
+    XCHECK(tracker.Enqueue(pcm, BUF, 1000));
+    XCHECK(tracker.Enqueue(pcm, BUF, 1020));
+    XCHECK(tracker.Count() == 3);
+    XCHECK(Near(tracker.QueuedMs(), 40 + 4 / 192.0));
+
+    //队首是静音：正在播放的时间 = 第一个有时间的缓冲减去前面静音的时长
+    double ms = 0;
+    XCHECK(tracker.PlayingMs(ms));
+    XCHECK(Near(ms, 1000 - 4 / 192.0));
+
+    //静音播放完，回调时队首1000ms的缓冲刚开始播放
+    sink.Finish();
+    tracker.SyncSink(0);
+    XCHECK(tracker.Count() == 2);
+    XCHECK(tracker.PlayingMs(ms) && Near(ms, 1000));
+    XCHECK(Near(tracker.QueuedMs(), 40));
+
+    //记录和设备都满时拒绝，不记录
+    XCHECK(tracker.Enqueue(pcm, BUF, 1040));
+    XCHECK(tracker.Enqueue(pcm, BUF, 1060));
+    XCHECK(!tracker.Enqueue(pcm, BUF, 1080));
+    XCHECK(tracker.Count() == 4);
+
+    //设备拒绝时也不记录
+    sink.Finish();
+    tracker.SyncSink(0);
+    sink.capacity = 3;
+    XCHECK(!tracker.Enqueue(pcm, BUF, 1080));
+    XCHECK(tracker.Count() == 3);
+    XCHECK(tracker.PlayingMs(ms) && Near(ms, 1020));
+
+    //一次回调前设备已经播完多个缓冲（回调延迟），按设备报告的数量一次移除
+    sink.Finish();
+    sink.Finish();
+    tracker.SyncSink(0);
+    XCHECK(tracker.Count() == 1);
+    XCHECK(tracker.PlayingMs(ms) && Near(ms, 1060));
+    XCHECK(Near(tracker.QueuedMs(), 20));
+    XCHECK(tracker.played == 4);
+
+    //设备无法报告状态时按调用者的计数同步
+    sink.isStateOk = false;
+    sink.Finish();
+    tracker.SyncSink(0);
+    XCHECK(tracker.Count() == 0);
+    XCHECK(!tracker.PlayingMs(ms));
+    XCHECK(Near(tracker.QueuedMs(), 0));
+
+    printf("XPcmTrackerTest passed\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+//唤醒延迟和空闲CPU对比：XQueue条件变量等待 与 原来的 std::list + XSleep(1) 轮询
+//生产者每隔2ms送入一个带时间戳的数据，消费者记录取到的延迟和本线程CPU时间
+#include "XQueue.h"
+#include <list>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+static const int COUNT = 500;
+static const int INTERVAL_US = 2000;
+
+static long long NowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double ThreadCpuMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void Report(const char *name, std::vector<long long> &lat, double cpuMs, double wallMs)
+{
+    std::sort(lat.begin(), lat.end());
+    printf("%-12s wakeup p50 %5lld us  p99 %5lld us  max %5lld us  consumer cpu %6.1f ms / %.0f ms (%.2f%%)\n",
+           name, lat[lat.size() / 2], lat[lat.size() * 99 / 100], lat.back(),
+           cpuMs, wallMs, cpuMs * 100 / wallMs);
+}
+
+static void BenchQueue()
+{
+    XQueue<long long> q(100);
+    std::vector<long long> lat;
+    double cpu = 0;
+    long long begin = NowUs();
+    std::thread consumer([&] {
+        double c0 = ThreadCpuMs();
+        for (int i = 0; i < COUNT; i++)
+        {
+            long long ts = 0;
+            q.Pop(ts);
+            lat.push_back(NowUs() - ts);
+        }
+        cpu = ThreadCpuMs() - c0;
+    });
+    for (int i = 0; i < COUNT; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(INTERVAL_US));
+        q.Push(NowUs());
+    }
+    consumer.join();
+    Report("XQueue", lat, cpu, (NowUs() - begin) / 1000.0);
+}
+
+static void BenchSleepList()
+{
+    std::list<long long> list;
+    std::mutex mux;
+    std::vector<long long> lat;
+    double cpu = 0;
+    long long begin = NowUs();
+    std::thread consumer([&] {
+        double c0 = ThreadCpuMs();
+        for (int i = 0; i < COUNT;)
+        {
+            mux.lock();
+            if (list.empty())
+            {
+                mux.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            long long ts = list.front();
+            list.pop_front();
+            mux.unlock();
+            lat.push_back(NowUs() - ts);
+            i++;
+        }
+        cpu = ThreadCpuMs() - c0;
+    });
+    for (int i = 0; i < COUNT; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(INTERVAL_US));
+        mux.lock();
+        list.push_back(NowUs());
+        mux.unlock();
+    }
+    consumer.join();
+    Report("list+sleep", lat, cpu, (NowUs() - begin) / 1000.0);
+}
+
+int main()
+{
+    BenchSleepList();
+    BenchQueue();
+    return 0;
+}
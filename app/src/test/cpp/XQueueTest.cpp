@@ -0,0 +1,193 @@
+//XRingBuffer和XQueue的双线程压力测试：生产者按顺序写入，消费者检查顺序且不丢失
+#include "XTest.h"
+#include "XRingBuffer.h"
+#include "XQueue.h"
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <atomic>
+
+static const int COUNT = 2000000;
+
+//无锁环形缓冲，满和空时自旋重试
+static void TestRing()
+{
+    XRingBuffer<int> ring(64);
+    XCHECK(ring.Capacity() == 64);
+    std::thread producer([&ring] {
+        for (int i = 0; i < COUNT; i++)
+        {
+            while (!ring.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+    int expect = 0;
+    while (expect < COUNT)
+    {
+        int v = -1;
+        if (!ring.TryPop(v))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        XCHECK(v == expect);
+        expect++;
+    }
+    producer.join();
+    int v = 0;
+    XCHECK(!ring.TryPop(v));
+    XCHECK(ring.Size() == 0);
+}
+
+//阻塞队列，容量很小使双方频繁进入等待；权重限制同时生效
+static void TestQueue()
+{
+    XQueue<int> q(8);
+    q.SetMaxWeight(100);
+    long long sum = 0;
+    std::thread producer([&q] {
+        for (int i = 0; i < COUNT; i++)
+            XCHECK(q.Push(i, i % 7));
+    });
+    for (int i = 0; i < COUNT; i++)
+    {
+        int v = -1;
+        XCHECK(q.Pop(v));
+        XCHECK(v == i);
+        XCHECK(q.Size() <= 8);
+        sum += v;
+    }
+    producer.join();
+    XCHECK(sum == (long long)COUNT * (COUNT - 1) / 2);
+    XCHECK(q.Size() == 0);
+    XCHECK(q.Weight() == 0);
+}
+
+//暂停握手：所属线程在检查点确认暂停，请求方等到确认后才访问该端
+struct PauseGate
+{
+    std::atomic<bool> isReq{false};
+    std::atomic<bool> isAck{false};
+
+    //所属线程调用
+    void Check()
+    {
+        if (!isReq) return;
+        isAck = true;
+        while (isReq) std::this_thread::yield();
+        isAck = false;
+    }
+    //其他线程调用
+    void Pause()
+    {
+        isReq = true;
+        while (!isAck) std::this_thread::yield();
+    }
+    void Resume()
+    {
+        isReq = false;
+    }
+};
+
+//生产、消费线程确认暂停后，其他线程（跳转清理、单步取帧）TryPop/TryPush
+//每个值只取出一次，每个来源的顺序不变
+static void TestOtherThreads()
+{
+    const int n = COUNT / 20;
+    XQueue<int> q(16);
+    std::vector<char> seen(n * 2, 0);
+    std::atomic<int> total{0};
+    std::atomic<int> expect{n * 2};
+    //消费线程和暂停时的其他线程交替访问，由握手保证不同时使用
+    int last = -1;
+    int lastOther = -1;
+    auto check = [&](int v) {
+        XCHECK(v >= 0 && v < n * 2 && !seen[v]);
+        seen[v] = 1;
+        int &prev = v < n ? last : lastOther;
+        XCHECK(v > prev);
+        prev = v;
+        total++;
+    };
+    PauseGate pushGate, popGate;
+    std::atomic<bool> isProduced{false};
+    std::thread producer([&] {
+        for (int i = 0; i < n;)
+        {
+            pushGate.Check();
+            if (q.Push(i, 0, 1)) i++;
+        }
+        isProduced = true;
+    });
+    std::thread consumer([&] {
+        while (total < expect)
+        {
+            popGate.Check();
+            int v = -1;
+            if (q.Pop(v, 1)) check(v);
+        }
+    });
+    int other = n;
+    while (!isProduced)
+    {
+        pushGate.Pause();
+        q.Wake();
+        popGate.Pause();
+        int v = -1;
+        for (int i = 0; i < 3 && q.TryPop(v); i++)
+            check(v);
+        if (other < n * 2 && q.TryPush(other)) other++;
+        popGate.Resume();
+        pushGate.Resume();
+        std::this_thread::yield();
+    }
+    producer.join();
+    expect = other;
+    consumer.join();
+    XCHECK(total == other);
+    for (int i = 0; i < other; i++)
+        XCHECK(seen[i]);
+    XCHECK(q.Size() == 0);
+}
+
+//超时、Wake和Close都要让阻塞的一方返回
+static void TestWakeup()
+{
+    XQueue<int> q(1);
+    int v = 0;
+    auto begin = std::chrono::steady_clock::now();
+    XCHECK(!q.Pop(v, 20));
+    XCHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(20));
+
+    XCHECK(q.Push(1));
+    XCHECK(!q.Push(2, 0, 20));
+
+    XCHECK(q.Pop(v) && v == 1);
+    std::thread waker([&q] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        q.Wake();
+    });
+    XCHECK(!q.Pop(v));
+    waker.join();
+
+    XCHECK(q.Push(3));
+    std::thread closer([&q] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        q.Close();
+    });
+    XCHECK(!q.Push(4));
+    closer.join();
+    XCHECK(!q.Pop(v));
+    q.Open();
+    XCHECK(q.Pop(v) && v == 3);
+}
+
+int main()
+{
+    TestRing();
+    TestQueue();
+    TestOtherThreads();
+    TestWakeup();
+    printf("XQueueTest passed\n");
+    return 0;
+}
@@ -0,0 +1,66 @@
+//WSOLA变速的CPU占用：10秒立体声44.1k PCM按播放时的块大小送入，统计各速度下处理时间占音频时长的比例
+//XStretchBench使用NEON/SSE点积，XStretchBenchScalar为标量对照
+#include "WSOLAStretch.h"
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+static const int RATE = 44100;
+static const int CHANNELS = 2;
+static const int SECONDS = 10;
+//重采样每次输出的帧数
+static const int CHUNK = 1024;
+
+static double CpuMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+int main()
+{
+    //几个谐波加少量噪声，接近音乐的相关性
+    std::vector<short> pcm(RATE * SECONDS * CHANNELS);
+    unsigned int seed = 1;
+    for(int i = 0; i < RATE * SECONDS; i++)
+    {
+        double t = (double)i / RATE;
+        double v = 0.3 * sin(2 * M_PI * 220 * t) + 0.2 * sin(2 * M_PI * 331 * t) + 0.1 * sin(2 * M_PI * 1250 * t);
+        seed = seed * 1103515245 + 12345;
+        v += ((seed >> 16) % 1000 - 500) / 50000.0;
+        for(int c = 0; c < CHANNELS; c++)
+            pcm[i * CHANNELS + c] = (short)(v * 32767 * (c ? 0.9 : 1.0));
+    }
+
+    XParameter para;
+    para.sample_rate = RATE;
+    para.channels = CHANNELS;
+    const double speeds[] = {0.5, 0.75, 1.25, 1.5, 2.0, 3.0};
+    for(double speed : speeds)
+    {
+        WSOLAStretch st;
+        st.Open(para);
+        st.SetSpeed(speed);
+        long long outBytes = 0;
+        double begin = CpuMs();
+        for(int f = 0; f + CHUNK <= RATE * SECONDS; f += CHUNK)
+        {
+            XData in;
+            in.Alloc(CHUNK * CHANNELS * 2, (const char *)(pcm.data() + f * CHANNELS));
+            in.isAudio = true;
+            XData out = st.Stretch(in);
+            outBytes += out.size > 0 ? out.size : 0;
+            out.Drop();
+            in.Drop();
+        }
+        double cpu = CpuMs() - begin;
+        //按输出的播放时长计算占一个核心的比例
+        double playMs = SECONDS * 1000.0 / speed;
+        printf("speed %.2f  cpu %7.1f ms  output %6.2f s  core %.2f%%\n",
+               speed, cpu, outBytes / (double)(RATE * CHANNELS * 2), cpu * 100 / playMs);
+        st.Close();
+    }
+    return 0;
+}
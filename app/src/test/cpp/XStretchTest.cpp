@@ -0,0 +1,83 @@
+//WSOLA变速切换回原速时输出连续：正弦输入在1.5倍速后恢复1.0，相邻采样的跳变不超过正弦本身的斜率范围
+#include "XTest.h"
+#include "WSOLAStretch.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+static const int RATE = 44100;
+static const int CHUNK = 1024;
+static const double AMP = 10000;
+static const double FREQ = 440;
+
+static long long inFrame = 0;
+
+static XData Sine()
+{
+    std::vector<short> pcm(CHUNK * 2);
+    for(int i = 0; i < CHUNK; i++, inFrame++)
+    {
+        short v = (short)(AMP * sin(2 * M_PI * FREQ * inFrame / RATE));
+        pcm[i * 2] = v;
+        pcm[i * 2 + 1] = v;
+    }
+    XData d;
+    d.Alloc((int)pcm.size() * 2, (const char *)pcm.data());
+    d.isAudio = true;
+    return d;
+}
+
+static void Append(XData d, std::vector<short> &out)
+{
+    const short *p = (const short *)d.data;
+    for(int i = 0; i < d.size / 2; i += 2)
+        out.push_back(p[i]);
+}
+
+int main()
+{
+    XParameter para;
+    para.sample_rate = RATE;
+    para.channels = 2;
+    WSOLAStretch st;
+    XCHECK(st.Open(para));
+
+    std::vector<short> out;
+    st.SetSpeed(1.5);
+    for(int i = 0; i < 40; i++)
+    {
+        XData in = Sine();
+        XData o = st.Stretch(in);
+        if(o.data) Append(o, out);
+        o.Drop();
+        in.Drop();
+    }
+    size_t switchAt = out.size();
+    XCHECK(switchAt > 0);
+
+    st.SetSpeed(1.0);
+    for(int i = 0; i < 20; i++)
+    {
+        XData in = Sine();
+        XData o = st.Stretch(in);
+        //回到透传后返回输入的引用
+        if(o.data) Append(o, out);
+        o.Drop();
+        in.Drop();
+    }
+    XCHECK(out.size() > switchAt + 10 * CHUNK);
+
+    //正弦相邻采样的最大差约为 2*pi*f/rate*amp，交叉淡化衔接时允许一倍余量
+    double maxStep = 2 * M_PI * FREQ / RATE * AMP * 2;
+    for(size_t i = 1; i < out.size(); i++)
+    {
+        if(std::abs(out[i] - out[i - 1]) > maxStep)
+        {
+            printf("jump %d at %d (switch at %d)\n", std::abs(out[i] - out[i - 1]), (int)i, (int)switchAt);
+            XCHECK(false);
+        }
+    }
+    st.Close();
+    printf("XStretchTest passed, %d samples\n", (int)out.size());
+    return 0;
+}
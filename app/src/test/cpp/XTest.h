@@ -0,0 +1,16 @@
+#ifndef XPLAY_XTEST_H
+#define XPLAY_XTEST_H
+
+#include <cstdio>
+#include <cstdlib>
+
+//主机单元测试的断言，失败时输出位置并以非0退出，由ctest判断结果
+#define XCHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d XCHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+
+#endif //XPLAY_XTEST_H
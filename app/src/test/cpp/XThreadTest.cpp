@@ -0,0 +1,67 @@
+//XThread暂停握手：确认、超时报告失败、析构时结束线程
+#include "XTest.h"
+#include "XThread.h"
+#include <chrono>
+
+//按暂停状态循环，block为true时模拟阻塞在无法唤醒的调用中
+class TestThread : public XThread
+{
+public:
+    std::atomic<bool> block{false};
+    std::atomic<int> loops{0};
+
+    void Main()
+    {
+        while (!isExit)
+        {
+            if (IsPause())
+            {
+                WaitPause();
+                continue;
+            }
+            while (block && !isExit)
+                XSleep(1);
+            loops++;
+            WaitTime(1);
+        }
+    }
+};
+
+int main()
+{
+    TestThread t;
+    XCHECK(t.Start());
+
+    //正常情况立即确认，确认后线程不再运行循环
+    XCHECK(t.SetPause(true));
+    int loops = t.loops;
+    XSleep(20);
+    XCHECK(t.loops == loops);
+    XCHECK(t.SetPause(false));
+    XSleep(20);
+    XCHECK(t.loops > loops);
+
+    //线程阻塞时超时返回false，不能当作已暂停
+    t.block = true;
+    XSleep(5);
+    t.pauseTimeoutMs = 30;
+    auto begin = std::chrono::steady_clock::now();
+    XCHECK(!t.SetPause(true));
+    XCHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(30));
+    t.block = false;
+    //再次等待直到确认
+    t.pauseTimeoutMs = -1;
+    XCHECK(t.SetPause(true));
+    XCHECK(t.SetPause(false));
+    t.Stop();
+
+    //未Stop就析构，析构中结束线程而不是脱离
+    {
+        TestThread *p = new TestThread();
+        p->Start();
+        XSleep(5);
+        delete p;
+    }
+    printf("XThreadTest passed\n");
+    return 0;
+}
@@ -0,0 +1,44 @@
+//缩略图生成速度：按工作线程数生成整条进度条的缩略图，输出ThumbsPerSec
+//用法 XThumbBench <媒体文件> [张数]
+#include "FFThumbnail.h"
+#include "XClock.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        printf("usage: %s <media file> [count]\n", argv[0]);
+        return 1;
+    }
+    int count = argc > 2 ? atoi(argv[2]) : 100;
+    const int workers[] = {1, 2, 4};
+    for(int w : workers)
+    {
+        FFThumbnail thumb;
+        thumb.workers = w;
+        if(!thumb.Open(argv[1], count, 160, 90))
+        {
+            printf("open %s failed\n", argv[1]);
+            return 1;
+        }
+        //全部完成，或5秒没有进展（有失败的位置）结束
+        int last = 0;
+        double lastMs = XNowMs();
+        while(thumb.DoneCount() < count && XNowMs() - lastMs < 5000)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if(thumb.DoneCount() != last)
+            {
+                last = thumb.DoneCount();
+                lastMs = XNowMs();
+            }
+        }
+        printf("workers %d  done %d/%d  %.1f thumbs/s\n", w, thumb.DoneCount(), count, thumb.ThumbsPerSec());
+        thumb.Close();
+    }
+    return 0;
+}